@@ -0,0 +1,830 @@
+#include "AnimationWriter.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_LIBWEBP
+#include <webp/encode.h>
+#include <webp/mux.h>
+#endif
+
+namespace {
+void putU16LE(std::vector<std::uint8_t> &out, unsigned v) {
+  out.push_back(static_cast<std::uint8_t>(v));
+  out.push_back(static_cast<std::uint8_t>(v >> 8));
+}
+
+void putU32(std::vector<std::uint8_t> &out, std::uint32_t v) {
+  out.push_back(static_cast<std::uint8_t>(v >> 24));
+  out.push_back(static_cast<std::uint8_t>(v >> 16));
+  out.push_back(static_cast<std::uint8_t>(v >> 8));
+  out.push_back(static_cast<std::uint8_t>(v));
+}
+
+void putU16(std::vector<std::uint8_t> &out, unsigned v) {
+  out.push_back(static_cast<std::uint8_t>(v >> 8));
+  out.push_back(static_cast<std::uint8_t>(v));
+}
+
+std::uint32_t pixelAt(const std::uint8_t *p, size_t i) {
+  std::uint32_t v;
+  std::memcpy(&v, p + i * 4, 4);
+  return v;
+}
+
+// Menor retangulo onde `changed(i)` vale para algum pixel; false se nenhum.
+template <typename Changed>
+bool changedRect(unsigned width, unsigned height, Changed changed,
+                 unsigned &x, unsigned &y, unsigned &w, unsigned &h) {
+  unsigned top = height, bottom = 0, left = width, right = 0;
+  for (unsigned r = 0; r < height; ++r) {
+    const size_t row = static_cast<size_t>(r) * width;
+    unsigned c = 0;
+    while (c < width && !changed(row + c))
+      ++c;
+    if (c == width)
+      continue;
+    unsigned last = width - 1;
+    while (last > c && !changed(row + last))
+      --last;
+    top = std::min(top, r);
+    bottom = r;
+    left = std::min(left, c);
+    right = std::max(right, last);
+  }
+  if (top == height)
+    return false;
+  x = left;
+  y = top;
+  w = right - left + 1;
+  h = bottom - top + 1;
+  return true;
+}
+
+// ---- GIF -------------------------------------------------------------------
+
+constexpr unsigned GIF_BINS = 1u << 18; // RGB666
+constexpr unsigned GIF_MAX_COLORS = 255;
+constexpr std::uint8_t GIF_TRANSPARENT = 255;
+constexpr size_t GIF_PALETTE_SAMPLES = 24;
+
+unsigned bin666(const std::uint8_t *p) {
+  return (static_cast<unsigned>(p[0] >> 2) << 12) |
+         (static_cast<unsigned>(p[1] >> 2) << 6) | (p[2] >> 2);
+}
+
+unsigned binChannel(unsigned key, int c) { return (key >> (12 - 6 * c)) & 63; }
+
+struct ColorBin {
+  unsigned key;
+  std::uint64_t count;
+  std::uint64_t sum[3];
+};
+
+struct ColorBox {
+  size_t begin, end;
+  std::uint64_t count;
+  int axis;
+  unsigned range;
+};
+
+ColorBox makeBox(const std::vector<ColorBin> &bins, size_t begin, size_t end) {
+  ColorBox box{begin, end, 0, 0, 0};
+  unsigned lo[3] = {63, 63, 63}, hi[3] = {0, 0, 0};
+  for (size_t i = begin; i < end; ++i) {
+    box.count += bins[i].count;
+    for (int c = 0; c < 3; ++c) {
+      lo[c] = std::min(lo[c], binChannel(bins[i].key, c));
+      hi[c] = std::max(hi[c], binChannel(bins[i].key, c));
+    }
+  }
+  for (int c = 0; c < 3; ++c) {
+    if (hi[c] - lo[c] > box.range || c == 0) {
+      box.range = hi[c] - lo[c];
+      box.axis = c;
+    }
+  }
+  return box;
+}
+
+// Median cut: divide sempre a caixa com maior populacao * extensao no eixo
+// mais longo, pela mediana ponderada. Com ate 255 cores distintas (comum na
+// interface) cada bin vira uma cor exata.
+std::vector<std::uint8_t> medianCut(std::vector<ColorBin> bins) {
+  std::vector<ColorBox> boxes;
+  if (!bins.empty())
+    boxes.push_back(makeBox(bins, 0, bins.size()));
+  while (boxes.size() < GIF_MAX_COLORS) {
+    size_t best = boxes.size();
+    std::uint64_t bestScore = 0;
+    for (size_t i = 0; i < boxes.size(); ++i) {
+      const std::uint64_t score = boxes[i].count * boxes[i].range;
+      if (boxes[i].end - boxes[i].begin > 1 && score > bestScore) {
+        bestScore = score;
+        best = i;
+      }
+    }
+    if (best == boxes.size())
+      break;
+    const ColorBox box = boxes[best];
+    std::sort(bins.begin() + box.begin, bins.begin() + box.end,
+              [axis = box.axis](const ColorBin &a, const ColorBin &b) {
+                return binChannel(a.key, axis) < binChannel(b.key, axis);
+              });
+    size_t split = box.begin;
+    std::uint64_t acc = 0;
+    while (split < box.end - 1 && acc + bins[split].count <= box.count / 2)
+      acc += bins[split++].count;
+    split = std::clamp(split, box.begin + 1, box.end - 1);
+    boxes[best] = makeBox(bins, box.begin, split);
+    boxes.push_back(makeBox(bins, split, box.end));
+  }
+
+  std::vector<std::uint8_t> palette;
+  for (const ColorBox &box : boxes) {
+    std::uint64_t sum[3] = {0, 0, 0};
+    for (size_t i = box.begin; i < box.end; ++i)
+      for (int c = 0; c < 3; ++c)
+        sum[c] += bins[i].sum[c];
+    for (int c = 0; c < 3; ++c)
+      palette.push_back(
+          static_cast<std::uint8_t>((sum[c] + box.count / 2) / box.count));
+  }
+  return palette;
+}
+
+// LZW do GIF com codigos de 3 a 12 bits, em sub-blocos de ate 255 bytes.
+void lzwEncode(const std::uint8_t *indices, size_t count, int minCodeSize,
+               std::vector<std::uint8_t> &out) {
+  constexpr unsigned HASH_SIZE = 8192;
+  constexpr unsigned MAX_CODE = 4095;
+  std::vector<std::uint32_t> keys(HASH_SIZE);
+  std::vector<std::uint16_t> codes(HASH_SIZE);
+  const unsigned clearCode = 1u << minCodeSize;
+  const unsigned endCode = clearCode + 1;
+  unsigned next = endCode + 1;
+  int codeSize = minCodeSize + 1;
+
+  std::vector<std::uint8_t> bytes;
+  std::uint32_t bits = 0;
+  int bitCount = 0;
+  auto emit = [&](unsigned code) {
+    bits |= code << bitCount;
+    bitCount += codeSize;
+    while (bitCount >= 8) {
+      bytes.push_back(static_cast<std::uint8_t>(bits));
+      bits >>= 8;
+      bitCount -= 8;
+    }
+  };
+  auto reset = [&]() {
+    std::fill(keys.begin(), keys.end(), 0);
+    next = endCode + 1;
+    codeSize = minCodeSize + 1;
+  };
+
+  emit(clearCode);
+  if (count > 0) {
+    unsigned prefix = indices[0];
+    for (size_t i = 1; i < count; ++i) {
+      const unsigned k = indices[i];
+      // chave + 1 para 0 marcar slot vazio
+      const std::uint32_t key = ((prefix << 8) | k) + 1;
+      unsigned h = (key * 2654435761u) >> 19;
+      while (keys[h] && keys[h] != key)
+        h = (h + 1) & (HASH_SIZE - 1);
+      if (keys[h] == key) {
+        prefix = codes[h];
+        continue;
+      }
+      emit(prefix);
+      if (next < MAX_CODE) {
+        keys[h] = key;
+        codes[h] = static_cast<std::uint16_t>(next++);
+        // O decodificador adiciona cada codigo um passo depois.
+        if (next > (1u << codeSize) && codeSize < 12)
+          ++codeSize;
+      } else {
+        emit(clearCode);
+        reset();
+      }
+      prefix = k;
+    }
+    emit(prefix);
+  }
+  emit(endCode);
+  if (bitCount > 0)
+    bytes.push_back(static_cast<std::uint8_t>(bits));
+
+  out.push_back(static_cast<std::uint8_t>(minCodeSize));
+  for (size_t pos = 0; pos < bytes.size(); pos += 255) {
+    const size_t n = std::min<size_t>(255, bytes.size() - pos);
+    out.push_back(static_cast<std::uint8_t>(n));
+    out.insert(out.end(), bytes.begin() + pos, bytes.begin() + pos + n);
+  }
+  out.push_back(0);
+}
+
+GifAnimationWriter::Encoded gifEncode(const std::vector<std::uint8_t> &cur,
+                                      const std::vector<std::uint8_t> *prev,
+                                      unsigned width, unsigned height) {
+  GifAnimationWriter::Encoded enc;
+  if (!prev || prev->empty()) {
+    enc.w = width;
+    enc.h = height;
+    lzwEncode(cur.data(), cur.size(), 8, enc.lzw);
+    return enc;
+  }
+  if (!changedRect(
+          width, height, [&](size_t i) { return cur[i] != (*prev)[i]; },
+          enc.x, enc.y, enc.w, enc.h)) {
+    enc.changed = false;
+    return enc;
+  }
+  enc.transparent = true;
+  std::vector<std::uint8_t> rect(static_cast<size_t>(enc.w) * enc.h);
+  for (unsigned r = 0; r < enc.h; ++r) {
+    const size_t src = static_cast<size_t>(enc.y + r) * width + enc.x;
+    for (unsigned c = 0; c < enc.w; ++c) {
+      const std::uint8_t v = cur[src + c];
+      rect[static_cast<size_t>(r) * enc.w + c] =
+          v == (*prev)[src + c] ? GIF_TRANSPARENT : v;
+    }
+  }
+  lzwEncode(rect.data(), rect.size(), 8, enc.lzw);
+  return enc;
+}
+
+std::string lowerExtension(const std::string &file) {
+  std::string ext = std::filesystem::path(file).extension().string();
+  for (char &ch : ext)
+    ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+  return ext;
+}
+} // namespace
+
+std::unique_ptr<AnimationWriter>
+AnimationWriter::create(const std::string &file) {
+  const std::string ext = lowerExtension(file);
+  if (ext == ".gif")
+    return std::make_unique<GifAnimationWriter>();
+#ifdef HAVE_ZLIB
+  if (ext == ".apng" || ext == ".png")
+    return std::make_unique<ApngAnimationWriter>();
+#endif
+#ifdef HAVE_LIBWEBP
+  if (ext == ".webp")
+    return std::make_unique<WebpAnimationWriter>();
+#endif
+  return nullptr;
+}
+
+void GifAnimationWriter::prepare(const FrameSource &frames) {
+  // Histograma RGB666 de ate GIF_PALETTE_SAMPLES frames espalhados, com a
+  // soma dos canais em 8 bits para a cor media de cada bin ser exata.
+  std::vector<std::uint32_t> count(GIF_BINS);
+  std::vector<std::uint64_t> sum(GIF_BINS * 3);
+  const size_t total = frames.frameCount();
+  const size_t samples = std::min(total, GIF_PALETTE_SAMPLES);
+  RawFrame frame;
+  for (size_t s = 0; s < samples; ++s) {
+    const size_t index = samples > 1 ? s * (total - 1) / (samples - 1) : 0;
+    if (!frames.readFrame(index, frame))
+      continue;
+    const size_t pixels = static_cast<size_t>(frame.width) * frame.height;
+    for (size_t i = 0; i < pixels; ++i) {
+      const std::uint8_t *p = frame.pixels.data() + i * 4;
+      const unsigned key = bin666(p);
+      ++count[key];
+      sum[key * 3] += p[0];
+      sum[key * 3 + 1] += p[1];
+      sum[key * 3 + 2] += p[2];
+    }
+  }
+  std::vector<ColorBin> bins;
+  for (unsigned key = 0; key < GIF_BINS; ++key)
+    if (count[key])
+      bins.push_back({key, count[key],
+                      {sum[key * 3], sum[key * 3 + 1], sum[key * 3 + 2]}});
+  m_palette = medianCut(std::move(bins));
+}
+
+void GifAnimationWriter::buildLookup() {
+  if (m_palette.empty()) {
+    // Sem prepare(): paleta uniforme 6x7x6.
+    for (unsigned r = 0; r < 6; ++r)
+      for (unsigned g = 0; g < 7; ++g)
+        for (unsigned b = 0; b < 6; ++b) {
+          m_palette.push_back(static_cast<std::uint8_t>(r * 255 / 5));
+          m_palette.push_back(static_cast<std::uint8_t>(g * 255 / 6));
+          m_palette.push_back(static_cast<std::uint8_t>(b * 255 / 5));
+        }
+  }
+  // Cor mais proxima de cada bin RGB666, em faixas paralelas.
+  m_lookup.assign(GIF_BINS, 0);
+  const size_t colors = m_palette.size() / 3;
+  const size_t bands = m_pool.size() * 4;
+  for (size_t band = 0; band < bands; ++band) {
+    m_pool.submit([this, band, bands, colors]() {
+      const unsigned begin = static_cast<unsigned>(GIF_BINS * band / bands);
+      const unsigned end = static_cast<unsigned>(GIF_BINS * (band + 1) / bands);
+      for (unsigned key = begin; key < end; ++key) {
+        int rgb[3];
+        for (int c = 0; c < 3; ++c) {
+          const unsigned v = binChannel(key, c);
+          rgb[c] = static_cast<int>((v << 2) | (v >> 4));
+        }
+        int bestDist = 1 << 30;
+        std::uint8_t best = 0;
+        for (size_t i = 0; i < colors; ++i) {
+          const int dr = rgb[0] - m_palette[i * 3];
+          const int dg = rgb[1] - m_palette[i * 3 + 1];
+          const int db = rgb[2] - m_palette[i * 3 + 2];
+          const int dist = dr * dr + dg * dg + db * db;
+          if (dist < bestDist) {
+            bestDist = dist;
+            best = static_cast<std::uint8_t>(i);
+          }
+        }
+        m_lookup[key] = best;
+      }
+    });
+  }
+  m_pool.waitIdle();
+}
+
+bool GifAnimationWriter::open(const std::string &file, unsigned width,
+                              unsigned height, int fps) {
+  if (width == 0 || height == 0 || width > 65535 || height > 65535) {
+    std::cerr << "[AnimationWriter] Tamanho invalido para GIF." << '\n';
+    return false;
+  }
+  m_out.open(file, std::ios::binary | std::ios::trunc);
+  if (!m_out) {
+    std::cerr << "[AnimationWriter] Falha ao criar " << file << '\n';
+    return false;
+  }
+  m_width = width;
+  m_height = height;
+  m_fps = fps > 0 ? fps : 30;
+  m_base.clear();
+  m_pendingIndices.clear();
+  m_hasPending = false;
+  m_pendingStart = m_ticks = 0;
+  buildLookup();
+
+  std::vector<std::uint8_t> header = {'G', 'I', 'F', '8', '9', 'a'};
+  putU16LE(header, width);
+  putU16LE(header, height);
+  header.push_back(0xF7); // tabela global de 256 cores, 8 bits
+  header.push_back(0);    // fundo
+  header.push_back(0);    // aspecto
+  std::vector<std::uint8_t> table = m_palette;
+  table.resize(256 * 3, 0);
+  header.insert(header.end(), table.begin(), table.end());
+  // NETSCAPE2.0: repete para sempre.
+  const std::uint8_t loop[] = {0x21, 0xFF, 0x0B, 'N', 'E', 'T', 'S', 'C', 'A',
+                               'P',  'E',  '2',  '.', '0', 0x03, 0x01, 0x00,
+                               0x00, 0x00};
+  header.insert(header.end(), std::begin(loop), std::end(loop));
+  m_out.write(reinterpret_cast<const char *>(header.data()),
+              static_cast<std::streamsize>(header.size()));
+  return m_out.good();
+}
+
+bool GifAnimationWriter::write(const std::vector<RawFrame> &frames,
+                               const std::vector<size_t> &ticks) {
+  const size_t n = std::min(ticks.size(), frames.size());
+  if (n == 0)
+    return true;
+  std::vector<std::vector<std::uint8_t>> indices(n);
+  for (size_t i = 0; i < n; ++i) {
+    m_pool.submit([this, i, &frames, &indices]() {
+      const size_t pixels = static_cast<size_t>(m_width) * m_height;
+      indices[i].resize(pixels);
+      const std::uint8_t *src = frames[i].pixels.data();
+      for (size_t p = 0; p < pixels; ++p)
+        indices[i][p] = m_lookup[bin666(src + p * 4)];
+    });
+  }
+  m_pool.waitIdle();
+
+  // Um frame so vira imagem no arquivo quando o seguinte chega pelo menos
+  // 2 cs depois do seu inicio (navegadores tratam atrasos < 2 como 10).
+  // Antes disso o seguinte toma o lugar dele e herda o inicio: a linha do
+  // tempo continua a do relogio, sem esticar clipes de 60 fps.
+  struct Emit {
+    const std::vector<std::uint8_t> *cur;
+    const std::vector<std::uint8_t> *base;
+    size_t start, end;
+  };
+  std::vector<Emit> emits;
+  std::vector<std::uint8_t> *pending = m_hasPending ? &m_pendingIndices : nullptr;
+  std::vector<std::uint8_t> *base = &m_base;
+  size_t pendingStart = m_pendingStart;
+  for (size_t i = 0; i < n; ++i) {
+    const size_t start = m_ticks;
+    m_ticks += ticks[i];
+    if (pending && indices[i] == *pending)
+      continue;
+    if (!pending) {
+      pendingStart = start;
+    } else if (centis(start) >= centis(pendingStart) + 2) {
+      emits.push_back({pending, base, pendingStart, start});
+      base = pending;
+      pendingStart = start;
+    }
+    pending = &indices[i];
+  }
+
+  // Cada imagem so depende da base (ultima gravada), ja decidida acima.
+  std::vector<Encoded> encoded(emits.size());
+  for (size_t i = 0; i < emits.size(); ++i) {
+    m_pool.submit([this, i, &emits, &encoded]() {
+      encoded[i] = gifEncode(*emits[i].cur, emits[i].base, m_width, m_height);
+    });
+  }
+  m_pool.waitIdle();
+  for (size_t i = 0; i < emits.size(); ++i)
+    writeFrame(encoded[i], emits[i].start, emits[i].end);
+
+  if (base == &m_pendingIndices)
+    m_base.swap(m_pendingIndices);
+  else if (base != &m_base)
+    m_base = std::move(*base);
+  if (pending != &m_pendingIndices)
+    m_pendingIndices = std::move(*pending);
+  m_pendingStart = pendingStart;
+  m_hasPending = true;
+  return m_out.good();
+}
+
+size_t GifAnimationWriter::centis(size_t ticks) const {
+  return (ticks * 100 + static_cast<size_t>(m_fps) / 2) /
+         static_cast<size_t>(m_fps);
+}
+
+void GifAnimationWriter::writeFrame(Encoded frame, size_t startTick,
+                                    size_t endTick) {
+  // Atraso em centesimos pelo tempo acumulado, sem deriva de arredondamento.
+  const size_t delay =
+      std::clamp<size_t>(centis(endTick) - centis(startTick), 2, 65535);
+  if (!frame.changed) {
+    // Voltou a ser igual a base depois de um frame absorvido: um pixel
+    // transparente so para ocupar o tempo.
+    const std::uint8_t clear = GIF_TRANSPARENT;
+    frame.x = frame.y = 0;
+    frame.w = frame.h = 1;
+    frame.transparent = true;
+    lzwEncode(&clear, 1, 8, frame.lzw);
+  }
+
+  std::vector<std::uint8_t> out = {0x21, 0xF9, 0x04};
+  // disposal 1 (mantem o frame) + flag de transparencia
+  out.push_back(static_cast<std::uint8_t>((1 << 2) |
+                                          (frame.transparent ? 1 : 0)));
+  putU16LE(out, static_cast<unsigned>(delay));
+  out.push_back(GIF_TRANSPARENT);
+  out.push_back(0);
+  out.push_back(0x2C);
+  putU16LE(out, frame.x);
+  putU16LE(out, frame.y);
+  putU16LE(out, frame.w);
+  putU16LE(out, frame.h);
+  out.push_back(0);
+  m_out.write(reinterpret_cast<const char *>(out.data()),
+              static_cast<std::streamsize>(out.size()));
+  m_out.write(reinterpret_cast<const char *>(frame.lzw.data()),
+              static_cast<std::streamsize>(frame.lzw.size()));
+}
+
+bool GifAnimationWriter::close() {
+  if (!m_out.is_open())
+    return false;
+  if (m_hasPending)
+    writeFrame(gifEncode(m_pendingIndices, &m_base, m_width, m_height),
+               m_pendingStart, m_ticks);
+  m_hasPending = false;
+  m_out.put(0x3B);
+  const bool ok = m_out.good();
+  m_out.close();
+  m_base.clear();
+  m_pendingIndices.clear();
+  return ok;
+}
+
+// ---- APNG ------------------------------------------------------------------
+
+#ifdef HAVE_ZLIB
+namespace {
+constexpr int APNG_LEVEL = 6;
+
+// Linhas com filtro PNG escolhido por linha (None, Sub ou Up, o de menor
+// soma absoluta) e deflate do resultado.
+std::vector<std::uint8_t> deflateRect(const std::vector<std::uint8_t> &rgba,
+                                      unsigned w, unsigned h) {
+  const size_t rowBytes = static_cast<size_t>(w) * 4;
+  std::vector<std::uint8_t> filtered((rowBytes + 1) * h);
+  std::vector<std::uint8_t> sub(rowBytes), up(rowBytes);
+  for (unsigned y = 0; y < h; ++y) {
+    const std::uint8_t *row = rgba.data() + y * rowBytes;
+    const std::uint8_t *above = y > 0 ? row - rowBytes : nullptr;
+    size_t costNone = 0, costSub = 0, costUp = 0;
+    for (size_t i = 0; i < rowBytes; ++i) {
+      sub[i] = static_cast<std::uint8_t>(row[i] - (i >= 4 ? row[i - 4] : 0));
+      up[i] = static_cast<std::uint8_t>(row[i] - (above ? above[i] : 0));
+      costNone += std::abs(static_cast<std::int8_t>(row[i]));
+      costSub += std::abs(static_cast<std::int8_t>(sub[i]));
+      costUp += std::abs(static_cast<std::int8_t>(up[i]));
+    }
+    std::uint8_t *dst = filtered.data() + y * (rowBytes + 1);
+    if (costSub <= costNone && costSub <= costUp) {
+      dst[0] = 1;
+      std::memcpy(dst + 1, sub.data(), rowBytes);
+    } else if (costUp <= costNone) {
+      dst[0] = 2;
+      std::memcpy(dst + 1, up.data(), rowBytes);
+    } else {
+      dst[0] = 0;
+      std::memcpy(dst + 1, row, rowBytes);
+    }
+  }
+  uLongf size = compressBound(static_cast<uLong>(filtered.size()));
+  std::vector<std::uint8_t> out(size);
+  if (compress2(out.data(), &size, filtered.data(),
+                static_cast<uLong>(filtered.size()), APNG_LEVEL) != Z_OK)
+    return {};
+  out.resize(size);
+  return out;
+}
+
+ApngAnimationWriter::Encoded apngEncode(const RawFrame &cur,
+                                        const RawFrame *prev) {
+  ApngAnimationWriter::Encoded enc;
+  const unsigned width = cur.width;
+  std::vector<std::uint8_t> rect;
+  if (!prev || prev->empty()) {
+    enc.w = cur.width;
+    enc.h = cur.height;
+    rect = cur.pixels;
+  } else {
+    const std::uint8_t *a = cur.pixels.data();
+    const std::uint8_t *b = prev->pixels.data();
+    if (!changedRect(
+            cur.width, cur.height,
+            [&](size_t i) { return pixelAt(a, i) != pixelAt(b, i); }, enc.x,
+            enc.y, enc.w, enc.h)) {
+      enc.changed = false;
+      return enc;
+    }
+    // OVER com alpha 0 preserva o pixel anterior; so vale se o frame inteiro
+    // do retangulo e opaco (captura de janela sempre e).
+    enc.blendOver = true;
+    for (unsigned r = 0; r < enc.h && enc.blendOver; ++r)
+      for (unsigned c = 0; c < enc.w; ++c)
+        if (a[((static_cast<size_t>(enc.y) + r) * width + enc.x + c) * 4 + 3] !=
+            255) {
+          enc.blendOver = false;
+          break;
+        }
+    rect.resize(static_cast<size_t>(enc.w) * enc.h * 4);
+    for (unsigned r = 0; r < enc.h; ++r) {
+      const size_t src = (static_cast<size_t>(enc.y) + r) * width + enc.x;
+      for (unsigned c = 0; c < enc.w; ++c) {
+        const std::uint32_t v = pixelAt(a, src + c);
+        const std::uint32_t out =
+            enc.blendOver && v == pixelAt(b, src + c) ? 0 : v;
+        std::memcpy(rect.data() + (static_cast<size_t>(r) * enc.w + c) * 4,
+                    &out, 4);
+      }
+    }
+  }
+  enc.deflated = deflateRect(rect, enc.w, enc.h);
+  return enc;
+}
+} // namespace
+
+void ApngAnimationWriter::chunk(const char *type,
+                                const std::vector<std::uint8_t> &data) {
+  std::vector<std::uint8_t> head;
+  putU32(head, static_cast<std::uint32_t>(data.size()));
+  head.insert(head.end(), type, type + 4);
+  uLong crc = crc32(0L, Z_NULL, 0);
+  crc = crc32(crc, reinterpret_cast<const Bytef *>(type), 4);
+  if (!data.empty())
+    crc = crc32(crc, data.data(), static_cast<uInt>(data.size()));
+  m_out.write(reinterpret_cast<const char *>(head.data()),
+              static_cast<std::streamsize>(head.size()));
+  m_out.write(reinterpret_cast<const char *>(data.data()),
+              static_cast<std::streamsize>(data.size()));
+  std::vector<std::uint8_t> tail;
+  putU32(tail, static_cast<std::uint32_t>(crc));
+  m_out.write(reinterpret_cast<const char *>(tail.data()), 4);
+}
+
+bool ApngAnimationWriter::open(const std::string &file, unsigned width,
+                               unsigned height, int fps) {
+  if (width == 0 || height == 0) {
+    std::cerr << "[AnimationWriter] Tamanho invalido para APNG." << '\n';
+    return false;
+  }
+  m_out.open(file, std::ios::binary | std::ios::trunc);
+  if (!m_out) {
+    std::cerr << "[AnimationWriter] Falha ao criar " << file << '\n';
+    return false;
+  }
+  m_width = width;
+  m_height = height;
+  m_fps = std::clamp(fps, 1, 65535);
+  m_prev = RawFrame();
+  m_sequence = m_frames = 0;
+  m_hasPending = false;
+  m_pendingTicks = 0;
+
+  const std::uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  m_out.write(reinterpret_cast<const char *>(signature), sizeof(signature));
+  std::vector<std::uint8_t> ihdr;
+  putU32(ihdr, width);
+  putU32(ihdr, height);
+  ihdr.insert(ihdr.end(), {8, 6, 0, 0, 0}); // RGBA 8 bits, sem entrelacamento
+  chunk("IHDR", ihdr);
+  // acTL e reescrito em close() com o numero final de frames.
+  m_actlPos = m_out.tellp();
+  chunk("acTL", std::vector<std::uint8_t>(8, 0));
+  return m_out.good();
+}
+
+bool ApngAnimationWriter::write(const std::vector<RawFrame> &frames,
+                                const std::vector<size_t> &ticks) {
+  const size_t n = std::min(ticks.size(), frames.size());
+  if (n == 0)
+    return true;
+  std::vector<Encoded> encoded(n);
+  for (size_t i = 0; i < n; ++i) {
+    m_pool.submit([this, i, &frames, &encoded]() {
+      encoded[i] = apngEncode(frames[i], i > 0 ? &frames[i - 1] : &m_prev);
+    });
+  }
+  m_pool.waitIdle();
+
+  for (size_t i = 0; i < n; ++i) {
+    if (!encoded[i].changed) {
+      m_pendingTicks += ticks[i];
+      continue;
+    }
+    if (encoded[i].deflated.empty())
+      return false;
+    flushPending();
+    m_pending = std::move(encoded[i]);
+    m_pendingTicks = ticks[i];
+    m_hasPending = true;
+  }
+  m_prev = frames[n - 1];
+  return m_out.good();
+}
+
+void ApngAnimationWriter::flushPending() {
+  if (!m_hasPending)
+    return;
+  std::vector<std::uint8_t> fctl;
+  putU32(fctl, m_sequence++);
+  putU32(fctl, m_pending.w);
+  putU32(fctl, m_pending.h);
+  putU32(fctl, m_pending.x);
+  putU32(fctl, m_pending.y);
+  // Duracao exata em ticks/fps.
+  putU16(fctl, static_cast<unsigned>(std::min<size_t>(m_pendingTicks, 65535)));
+  putU16(fctl, static_cast<unsigned>(m_fps));
+  fctl.push_back(0); // dispose NONE
+  fctl.push_back(m_pending.blendOver ? 1 : 0);
+  chunk("fcTL", fctl);
+  if (m_frames == 0) {
+    // O primeiro frame e tambem a imagem padrao (IDAT).
+    chunk("IDAT", m_pending.deflated);
+  } else {
+    std::vector<std::uint8_t> fdat;
+    fdat.reserve(m_pending.deflated.size() + 4);
+    putU32(fdat, m_sequence++);
+    fdat.insert(fdat.end(), m_pending.deflated.begin(),
+                m_pending.deflated.end());
+    chunk("fdAT", fdat);
+  }
+  ++m_frames;
+  m_hasPending = false;
+  m_pending = Encoded();
+}
+
+bool ApngAnimationWriter::close() {
+  if (!m_out.is_open())
+    return false;
+  flushPending();
+  chunk("IEND", {});
+  std::vector<std::uint8_t> actl;
+  putU32(actl, m_frames);
+  putU32(actl, 0); // repete para sempre
+  m_out.seekp(m_actlPos);
+  chunk("acTL", actl);
+  const bool ok = m_out.good() && m_frames > 0;
+  m_out.close();
+  m_prev = RawFrame();
+  return ok;
+}
+#endif
+
+// ---- WebP ------------------------------------------------------------------
+
+#ifdef HAVE_LIBWEBP
+WebpAnimationWriter::~WebpAnimationWriter() {
+  if (m_encoder)
+    WebPAnimEncoderDelete(m_encoder);
+}
+
+int WebpAnimationWriter::timestampMs(size_t ticks) const {
+  return static_cast<int>((ticks * 1000 + static_cast<size_t>(m_fps) / 2) /
+                          static_cast<size_t>(m_fps));
+}
+
+bool WebpAnimationWriter::open(const std::string &file, unsigned width,
+                               unsigned height, int fps) {
+  WebPAnimEncoderOptions options;
+  if (!WebPAnimEncoderOptionsInit(&options))
+    return false;
+  options.anim_params.loop_count = 0;
+  m_encoder = WebPAnimEncoderNew(static_cast<int>(width),
+                                 static_cast<int>(height), &options);
+  if (!m_encoder) {
+    std::cerr << "[AnimationWriter] Falha ao iniciar WebPAnimEncoder." << '\n';
+    return false;
+  }
+  m_file = file;
+  m_width = width;
+  m_height = height;
+  m_fps = fps > 0 ? fps : 30;
+  m_ticks = 0;
+  return true;
+}
+
+bool WebpAnimationWriter::write(const std::vector<RawFrame> &frames,
+                                const std::vector<size_t> &ticks) {
+  const size_t n = std::min(ticks.size(), frames.size());
+  if (!m_encoder)
+    return false;
+  std::vector<WebPPicture> pictures(n);
+  std::vector<char> imported(n, 0);
+  for (size_t i = 0; i < n; ++i) {
+    m_pool.submit([this, i, &frames, &pictures, &imported]() {
+      WebPPicture &pic = pictures[i];
+      WebPPictureInit(&pic);
+      pic.width = static_cast<int>(m_width);
+      pic.height = static_cast<int>(m_height);
+      pic.use_argb = 1;
+      imported[i] = WebPPictureImportRGBA(&pic, frames[i].pixels.data(),
+                                          static_cast<int>(m_width * 4));
+    });
+  }
+  m_pool.waitIdle();
+
+  WebPConfig config;
+  bool ok = WebPConfigInit(&config) && WebPConfigLosslessPreset(&config, 1);
+  config.thread_level = 1;
+  for (size_t i = 0; i < n; ++i) {
+    ok = ok && imported[i] &&
+         WebPAnimEncoderAdd(m_encoder, &pictures[i], timestampMs(m_ticks),
+                            &config);
+    m_ticks += ticks[i];
+    WebPPictureFree(&pictures[i]);
+  }
+  if (!ok)
+    std::cerr << "[AnimationWriter] WebP: "
+              << WebPAnimEncoderGetError(m_encoder) << '\n';
+  return ok;
+}
+
+bool WebpAnimationWriter::close() {
+  if (!m_encoder)
+    return false;
+  WebPData data;
+  WebPDataInit(&data);
+  bool ok = WebPAnimEncoderAdd(m_encoder, nullptr, timestampMs(m_ticks),
+                               nullptr) &&
+            WebPAnimEncoderAssemble(m_encoder, &data);
+  if (ok) {
+    std::ofstream out(m_file, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(data.bytes),
+              static_cast<std::streamsize>(data.size));
+    ok = out.good();
+  } else {
+    std::cerr << "[AnimationWriter] WebP: "
+              << WebPAnimEncoderGetError(m_encoder) << '\n';
+  }
+  WebPDataClear(&data);
+  WebPAnimEncoderDelete(m_encoder);
+  m_encoder = nullptr;
+  return ok;
+}
+#endif
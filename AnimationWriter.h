@@ -0,0 +1,134 @@
+#pragma once
+#include "FrameSource.h"
+#include "RawFrame.h"
+#include "WorkerPool.h"
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Animacao em arquivo unico (GIF, APNG, WebP animado), montada direto dos
+// frames em memoria. Os frames chegam em lotes consecutivos para que a
+// quantizacao/compressao de cada lote rode em paralelo no pool; a escrita
+// no arquivo continua sequencial. Frames que nao mudam nada somam a duracao
+// ao anterior.
+class AnimationWriter {
+public:
+    virtual ~AnimationWriter() = default;
+
+    // Pelo sufixo: .gif, .apng/.png ou .webp. nullptr se o formato nao e
+    // conhecido ou nao foi compilado (APNG pede zlib, WebP pede libwebp).
+    static std::unique_ptr<AnimationWriter> create(const std::string& file);
+    static bool supported(const std::string& file) { return create(file) != nullptr; }
+
+    virtual bool open(const std::string& file, unsigned width, unsigned height, int fps) = 0;
+    // Passada opcional sobre todos os frames antes do primeiro write (o GIF
+    // monta a paleta global por amostragem).
+    virtual void prepare(const FrameSource&) {}
+    // `ticks[i]` = quantos frames do fps de open() o frame i dura.
+    virtual bool write(const std::vector<RawFrame>& frames, const std::vector<size_t>& ticks) = 0;
+    virtual bool close() = 0;
+
+    // Tamanho de lote que mantem o pool ocupado.
+    size_t batchSize() const { return m_pool.size() * 2; }
+
+protected:
+    WorkerPool m_pool;
+};
+
+// GIF89a com paleta global de ate 255 cores (median cut sobre um histograma
+// RGB666) e o indice 255 transparente: a partir do segundo frame so o
+// retangulo que mudou e gravado, com os pixels iguais ao frame anterior
+// transparentes. Sem dithering; a interface tem poucas cores chapadas.
+class GifAnimationWriter : public AnimationWriter {
+public:
+    bool open(const std::string& file, unsigned width, unsigned height, int fps) override;
+    void prepare(const FrameSource& frames) override;
+    bool write(const std::vector<RawFrame>& frames, const std::vector<size_t>& ticks) override;
+    bool close() override;
+
+    struct Encoded {
+        bool changed = true;
+        unsigned x = 0, y = 0, w = 0, h = 0;
+        bool transparent = false;
+        std::vector<std::uint8_t> lzw;
+    };
+
+private:
+    void buildLookup();
+    size_t centis(size_t ticks) const;
+    void writeFrame(Encoded frame, size_t startTick, size_t endTick);
+
+    std::ofstream m_out;
+    unsigned m_width = 0;
+    unsigned m_height = 0;
+    int m_fps = 30;
+    std::vector<std::uint8_t> m_palette;  // RGB, ate 255 cores
+    std::vector<std::uint8_t> m_lookup;   // RGB666 -> indice
+    std::vector<std::uint8_t> m_base;     // indices da ultima imagem gravada
+    // Frame que ainda nao sabe quanto dura (o seguinte nao chegou).
+    std::vector<std::uint8_t> m_pendingIndices;
+    size_t m_pendingStart = 0;            // tick em que ele comeca
+    size_t m_ticks = 0;                   // ticks recebidos ate agora
+    bool m_hasPending = false;
+};
+
+#ifdef HAVE_ZLIB
+// PNG animado (RGBA 8 bits). Cada frame grava o retangulo que mudou com
+// blend OVER e os pixels iguais zerados (alpha 0), o que comprime bem;
+// filtragem e deflate de cada frame rodam em paralelo.
+class ApngAnimationWriter : public AnimationWriter {
+public:
+    bool open(const std::string& file, unsigned width, unsigned height, int fps) override;
+    bool write(const std::vector<RawFrame>& frames, const std::vector<size_t>& ticks) override;
+    bool close() override;
+
+    struct Encoded {
+        bool changed = true;
+        unsigned x = 0, y = 0, w = 0, h = 0;
+        bool blendOver = false;
+        std::vector<std::uint8_t> deflated;
+    };
+
+private:
+    void chunk(const char* type, const std::vector<std::uint8_t>& data);
+    void flushPending();
+
+    std::ofstream m_out;
+    unsigned m_width = 0;
+    unsigned m_height = 0;
+    int m_fps = 30;
+    RawFrame m_prev;
+    std::streampos m_actlPos = 0;
+    std::uint32_t m_sequence = 0;
+    std::uint32_t m_frames = 0;
+    Encoded m_pending;
+    size_t m_pendingTicks = 0;
+    bool m_hasPending = false;
+};
+#endif
+
+#ifdef HAVE_LIBWEBP
+struct WebPAnimEncoder;
+// WebP animado sem perda via WebPAnimEncoder (libwebpmux), que ja recorta
+// e funde frames iguais. A conversao RGBA -> ARGB de cada lote e paralela;
+// a codificacao usa as threads internas da libwebp.
+class WebpAnimationWriter : public AnimationWriter {
+public:
+    ~WebpAnimationWriter() override;
+    bool open(const std::string& file, unsigned width, unsigned height, int fps) override;
+    bool write(const std::vector<RawFrame>& frames, const std::vector<size_t>& ticks) override;
+    bool close() override;
+
+private:
+    int timestampMs(size_t ticks) const;
+
+    std::string m_file;
+    WebPAnimEncoder* m_encoder = nullptr;
+    unsigned m_width = 0;
+    unsigned m_height = 0;
+    int m_fps = 30;
+    size_t m_ticks = 0;
+};
+#endif
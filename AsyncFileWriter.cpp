@@ -0,0 +1,237 @@
+#include "AsyncFileWriter.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <unistd.h>
+
+std::unique_ptr<AsyncFileWriter> AsyncFileWriter::create(size_t queueDepth) {
+#ifdef HAVE_LIBURING
+  auto uring = std::make_unique<UringFileWriter>(queueDepth);
+  if (uring->ready())
+    return uring;
+  std::cerr << "[AsyncFileWriter] io_uring indisponivel; usando pwrite."
+            << '\n';
+#endif
+  return std::make_unique<PwriteFileWriter>(queueDepth);
+}
+
+void AsyncFileWriter::write(std::string path, std::vector<std::uint8_t> data,
+                            DoneFn onDone) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (!m_thread.joinable())
+    m_thread = std::thread(&AsyncFileWriter::ioLoop, this);
+  if (!m_started) {
+    m_started = true;
+    m_start = m_last = std::chrono::steady_clock::now();
+  }
+  m_cv.wait(lock, [this] { return m_queue.size() < m_queueDepth; });
+  Request req;
+  req.path = std::move(path);
+  req.data = std::move(data);
+  req.onDone = std::move(onDone);
+  m_queue.push_back(std::move(req));
+  m_cv.notify_all();
+}
+
+bool AsyncFileWriter::flush() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_cv.wait(lock, [this] { return m_queue.empty() && m_inFlight == 0; });
+  const bool ok = !m_failed;
+  m_failed = false;
+  return ok;
+}
+
+FileWriteStats AsyncFileWriter::stats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  FileWriteStats s;
+  s.files = m_files;
+  s.bytes = m_bytes;
+  s.queued = m_queue.size() + m_inFlight;
+  if (m_started)
+    s.seconds = std::chrono::duration<double>(m_last - m_start).count();
+  return s;
+}
+
+void AsyncFileWriter::stop() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  if (m_thread.joinable())
+    m_thread.join();
+}
+
+void AsyncFileWriter::ioLoop() {
+  std::vector<Request> batch;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+      // Mesmo parando, o que ja esta na fila e gravado.
+      if (m_queue.empty())
+        return;
+      const size_t n = std::min(m_queue.size(), MAX_BATCH);
+      for (size_t i = 0; i < n; ++i) {
+        batch.push_back(std::move(m_queue.front()));
+        m_queue.pop_front();
+      }
+      m_inFlight = n;
+    }
+
+    writeBatch(batch);
+
+    size_t bytes = 0;
+    bool failed = false;
+    for (Request &req : batch) {
+      if (req.ok)
+        bytes += req.data.size();
+      else
+        failed = true;
+      if (req.onDone)
+        req.onDone(req.ok);
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_files += batch.size();
+      m_bytes += bytes;
+      m_failed = m_failed || failed;
+      m_inFlight = 0;
+      m_last = std::chrono::steady_clock::now();
+    }
+    batch.clear();
+    m_cv.notify_all();
+  }
+}
+
+int AsyncFileWriter::openPreallocated(const std::string &path, size_t size) {
+  const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                        0644);
+  if (fd < 0) {
+    std::cerr << "[AsyncFileWriter] Falha ao abrir " << path << ": "
+              << std::strerror(errno) << '\n';
+    return -1;
+  }
+  // Reserva os blocos de uma vez: menos fragmentacao e sem estender o
+  // arquivo a cada escrita. Sem suporte no sistema de arquivos so se perde
+  // a dica; disco cheio ja falha aqui.
+  if (size > 0) {
+    const int err = ::posix_fallocate(fd, 0, static_cast<off_t>(size));
+    if (err == ENOSPC) {
+      std::cerr << "[AsyncFileWriter] Sem espaco para " << path << '\n';
+      ::close(fd);
+      return -1;
+    }
+  }
+  return fd;
+}
+
+bool PwriteFileWriter::writeWhole(const std::string &path,
+                                  const std::vector<std::uint8_t> &data) {
+  const int fd = openPreallocated(path, data.size());
+  if (fd < 0)
+    return false;
+  size_t off = 0;
+  while (off < data.size()) {
+    const ssize_t n = ::pwrite(fd, data.data() + off, data.size() - off,
+                               static_cast<off_t>(off));
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0) {
+      std::cerr << "[AsyncFileWriter] Falha ao gravar " << path << ": "
+                << std::strerror(errno) << '\n';
+      ::close(fd);
+      return false;
+    }
+    off += static_cast<size_t>(n);
+  }
+  return ::close(fd) == 0;
+}
+
+void PwriteFileWriter::writeBatch(std::vector<Request> &batch) {
+  for (Request &req : batch)
+    m_pool.submit([&req] { req.ok = writeWhole(req.path, req.data); });
+  m_pool.waitIdle();
+}
+
+#ifdef HAVE_LIBURING
+UringFileWriter::UringFileWriter(size_t queueDepth)
+    : AsyncFileWriter(queueDepth) {
+  const int err = io_uring_queue_init(MAX_BATCH, &m_ring, 0);
+  m_ready = err == 0;
+}
+
+UringFileWriter::~UringFileWriter() {
+  stop();
+  if (m_ready)
+    io_uring_queue_exit(&m_ring);
+}
+
+void UringFileWriter::writeBatch(std::vector<Request> &batch) {
+  // open + fallocate sao sincronos; as escritas do lote vao todas na mesma
+  // submissao.
+  std::vector<int> fds(batch.size(), -1);
+  std::vector<size_t> offsets(batch.size(), 0);
+  auto queue = [&](size_t i) {
+    io_uring_sqe *sqe = io_uring_get_sqe(&m_ring);
+    const std::vector<std::uint8_t> &data = batch[i].data;
+    io_uring_prep_write(sqe, fds[i], data.data() + offsets[i],
+                        static_cast<unsigned>(data.size() - offsets[i]),
+                        offsets[i]);
+    io_uring_sqe_set_data(sqe, reinterpret_cast<void *>(i));
+  };
+  size_t pending = 0;
+  for (size_t i = 0; i < batch.size(); ++i) {
+    fds[i] = openPreallocated(batch[i].path, batch[i].data.size());
+    if (fds[i] < 0)
+      continue;
+    if (batch[i].data.empty()) {
+      batch[i].ok = true;
+      continue;
+    }
+    queue(i);
+    ++pending;
+  }
+
+  while (pending > 0) {
+    io_uring_submit(&m_ring);
+    io_uring_cqe *cqe = nullptr;
+    const int err = io_uring_wait_cqe(&m_ring, &cqe);
+    if (err == -EINTR)
+      continue;
+    if (err < 0) {
+      // Anel em estado invalido: os pendentes ficam como falha.
+      std::cerr << "[AsyncFileWriter] io_uring_wait_cqe: "
+                << std::strerror(-err) << '\n';
+      break;
+    }
+    const size_t i = reinterpret_cast<size_t>(io_uring_cqe_get_data(cqe));
+    const int res = cqe->res;
+    io_uring_cqe_seen(&m_ring, cqe);
+    Request &req = batch[i];
+    if (res == -EINTR || res == -EAGAIN) {
+      queue(i);
+      continue;
+    }
+    if (res <= 0) {
+      std::cerr << "[AsyncFileWriter] Falha ao gravar " << req.path << ": "
+                << std::strerror(res < 0 ? -res : EIO) << '\n';
+      --pending;
+      continue;
+    }
+    offsets[i] += static_cast<size_t>(res);
+    if (offsets[i] < req.data.size()) {
+      queue(i); // escrita curta: reenvia o restante
+    } else {
+      req.ok = true;
+      --pending;
+    }
+  }
+
+  for (size_t i = 0; i < batch.size(); ++i)
+    if (fds[i] >= 0 && ::close(fds[i]) != 0)
+      batch[i].ok = false;
+}
+#endif
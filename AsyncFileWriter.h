@@ -0,0 +1,124 @@
+#pragma once
+#include "WorkerPool.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Estado da fila de escrita, para o progresso de export.
+struct FileWriteStats {
+    size_t files = 0;   // arquivos ja gravados
+    size_t bytes = 0;   // bytes ja gravados
+    size_t queued = 0;  // buffers esperando ou em escrita
+    double seconds = 0; // do primeiro write() a ultima conclusao
+
+    double bytesPerSecond() const { return seconds > 0 ? bytes / seconds : 0.0; }
+};
+using WriteStatsFn = std::function<void(const FileWriteStats&)>;
+
+// Grava arquivos inteiros (buffer ja codificado) fora da thread que os
+// produz: uma thread de I/O tira lotes da fila e o backend os grava de uma
+// vez. Cada arquivo e pre-alocado com o tamanho final antes da escrita.
+// write() bloqueia quando ha queueDepth buffers esperando (backpressure),
+// enquanto o lote anterior ainda esta sendo gravado.
+class AsyncFileWriter {
+public:
+    using DoneFn = std::function<void(bool)>;
+
+    explicit AsyncFileWriter(size_t queueDepth = 16) : m_queueDepth(queueDepth ? queueDepth : 1) {}
+    // Subclasses chamam stop() no proprio destrutor (writeBatch e virtual).
+    virtual ~AsyncFileWriter() = default;
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    // io_uring quando compilado com HAVE_LIBURING e o kernel aceita; senao
+    // pwrite num pool de threads.
+    static std::unique_ptr<AsyncFileWriter> create(size_t queueDepth = 16);
+
+    // onDone roda na thread de I/O com o resultado da escrita.
+    void write(std::string path, std::vector<std::uint8_t> data, DoneFn onDone = nullptr);
+    // Espera a fila esvaziar; false se alguma escrita falhou desde o ultimo
+    // flush.
+    bool flush();
+    FileWriteStats stats() const;
+    virtual const char* backend() const = 0;
+
+protected:
+    struct Request {
+        std::string path;
+        std::vector<std::uint8_t> data;
+        DoneFn onDone;
+        bool ok = false;
+    };
+    static constexpr size_t MAX_BATCH = 16;
+
+    // Grava o lote e preenche Request::ok; so na thread de I/O.
+    virtual void writeBatch(std::vector<Request>& batch) = 0;
+    void stop();
+
+    // Abre para escrita (truncando) e pre-aloca `size` bytes; -1 se falhar.
+    static int openPreallocated(const std::string& path, size_t size);
+
+private:
+    void ioLoop();
+
+    size_t m_queueDepth;
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Request> m_queue;
+    size_t m_inFlight = 0;
+    size_t m_files = 0;
+    size_t m_bytes = 0;
+    bool m_failed = false;
+    bool m_stop = false;
+    bool m_started = false;
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::steady_clock::time_point m_last; // ultima conclusao
+};
+
+// pwrite() de cada arquivo do lote em paralelo num pool.
+class PwriteFileWriter : public AsyncFileWriter {
+public:
+    explicit PwriteFileWriter(size_t queueDepth = 16, size_t threads = 4)
+        : AsyncFileWriter(queueDepth), m_pool(threads) {}
+    ~PwriteFileWriter() override { stop(); }
+    const char* backend() const override { return "pwrite"; }
+
+    static bool writeWhole(const std::string& path, const std::vector<std::uint8_t>& data);
+
+protected:
+    void writeBatch(std::vector<Request>& batch) override;
+
+private:
+    WorkerPool m_pool;
+};
+
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+
+// Um io_uring: o lote inteiro vai numa submissao so e as conclusoes sao
+// colhidas juntas; escritas curtas sao reenviadas com o restante.
+class UringFileWriter : public AsyncFileWriter {
+public:
+    explicit UringFileWriter(size_t queueDepth = 16);
+    ~UringFileWriter() override;
+    // false se o kernel recusou io_uring (ex.: seccomp em containers).
+    bool ready() const { return m_ready; }
+    const char* backend() const override { return "io_uring"; }
+
+protected:
+    void writeBatch(std::vector<Request>& batch) override;
+
+private:
+    io_uring m_ring;
+    bool m_ready = false;
+};
+#endif
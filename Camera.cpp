@@ -0,0 +1,44 @@
+#include "Camera.h"
+#include <algorithm>
+
+Camera::Camera(sf::Vector2u windowSize)
+    : m_windowSize(static_cast<float>(windowSize.x),
+                   static_cast<float>(windowSize.y)) {
+  reset();
+}
+
+void Camera::resize(sf::Vector2u windowSize) {
+  sf::Vector2f center = m_view.getCenter();
+  sf::Vector2f oldTopLeft = center - m_view.getSize() / 2.f;
+  m_windowSize = {static_cast<float>(windowSize.x),
+                  static_cast<float>(windowSize.y)};
+  // Mantem o canto superior esquerdo fixo, como o redimensionamento sem camera.
+  m_view.setSize(m_windowSize * m_zoom);
+  m_view.setCenter(oldTopLeft + m_view.getSize() / 2.f);
+}
+
+void Camera::pan(sf::Vector2f pixels) { m_view.move(pixels * m_zoom); }
+
+void Camera::zoomAt(sf::Vector2i pixel, float factor,
+                    const sf::RenderTarget &target) {
+  float newZoom = std::clamp(m_zoom * factor, MIN_ZOOM, MAX_ZOOM);
+  if (newZoom == m_zoom)
+    return;
+  sf::Vector2f before = target.mapPixelToCoords(pixel, m_view);
+  m_view.zoom(newZoom / m_zoom);
+  m_zoom = newZoom;
+  sf::Vector2f after = target.mapPixelToCoords(pixel, m_view);
+  m_view.move(before - after);
+}
+
+void Camera::reset() {
+  m_zoom = 1.f;
+  m_view.setSize(m_windowSize);
+  m_view.setCenter(m_windowSize / 2.f);
+}
+
+sf::FloatRect Camera::visibleArea() const {
+  sf::Vector2f size = m_view.getSize();
+  sf::Vector2f center = m_view.getCenter();
+  return {center.x - size.x / 2.f, center.y - size.y / 2.f, size.x, size.y};
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+
+// Camera 2D (pan/zoom) sobre a area das estruturas. As coordenadas de mundo
+// sao as mesmas usadas pelos visualizadores com zoom 1.
+class Camera {
+public:
+    explicit Camera(sf::Vector2u windowSize);
+
+    void resize(sf::Vector2u windowSize);
+    void pan(sf::Vector2f pixels);
+    void zoomAt(sf::Vector2i pixel, float factor, const sf::RenderTarget& target);
+    void reset();
+
+    const sf::View& view() const { return m_view; }
+    sf::FloatRect visibleArea() const;
+    float pixelsPerUnit() const { return 1.f / m_zoom; }
+    float zoom() const { return m_zoom; }
+
+    static constexpr float MIN_ZOOM = 0.125f;
+    static constexpr float MAX_ZOOM = 1.0e6f;
+
+private:
+    sf::Vector2f m_windowSize;
+    sf::View m_view;
+    float m_zoom = 1.f;
+};
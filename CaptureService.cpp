@@ -0,0 +1,62 @@
+#include "CaptureService.h"
+
+CaptureService::Id CaptureService::subscribe(FrameSink &sink,
+                                             const sf::IntRect &region) {
+  Subscriber sub;
+  sub.sink = &sink;
+  sub.region = region;
+  m_subscribers.push_back(sub);
+  return m_subscribers.size() - 1;
+}
+
+void CaptureService::setRegion(Id id, const sf::IntRect &region) {
+  if (id < m_subscribers.size())
+    m_subscribers[id].region = region;
+}
+
+void CaptureService::unsubscribe(Id id) {
+  if (id < m_subscribers.size())
+    m_subscribers[id].sink = nullptr;
+}
+
+bool CaptureService::active() const {
+  for (const auto &sub : m_subscribers)
+    if (sub.sink && sub.sink->capturing())
+      return true;
+  return false;
+}
+
+void CaptureService::deliver(const FrameView &view) {
+  // No modo PBO o frame entregue foi disparado na chamada anterior; vai para
+  // quem estava capturando naquele momento.
+  const bool async = m_grabber.asynchronous();
+  for (const auto &sub : m_subscribers)
+    if (sub.sink && (async ? sub.inFlight : sub.wanted))
+      sub.sink->accept(view, sub.region);
+}
+
+void CaptureService::capture(sf::RenderTarget &target) {
+  if (!active()) {
+    // Captura desligada: entrega o ultimo frame ainda em voo.
+    flush(target);
+    return;
+  }
+  for (auto &sub : m_subscribers) {
+    sub.wanted = sub.sink && sub.sink->capturing();
+    if (sub.wanted)
+      sub.sink->requested();
+  }
+  m_stats.begin();
+  m_grabber.grab(target, [this](const FrameView &view) { deliver(view); });
+  m_stats.end();
+  for (auto &sub : m_subscribers)
+    sub.inFlight = sub.wanted;
+}
+
+void CaptureService::flush(sf::RenderTarget &target) {
+  if (m_grabber.pending())
+    m_grabber.flush(target,
+                    [this](const FrameView &view) { deliver(view); });
+  for (auto &sub : m_subscribers)
+    sub.inFlight = false;
+}
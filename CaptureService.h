@@ -0,0 +1,45 @@
+#pragma once
+#include "FrameGrabber.h"
+#include "FrameSink.h"
+#include "FrameStats.h"
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <vector>
+
+// Captura unica por frame da janela (ou de qualquer RenderTarget): uma so
+// leitura via FrameGrabber, repartida entre os FrameSinks inscritos
+// (FrameRecorder, LiveVideoSink), cada um com sua regiao (painel do vetor, da lista ou a janela inteira). Os
+// recortes sao copiados direto do buffer lido, sem copia do frame inteiro.
+class CaptureService {
+public:
+    using Id = size_t;
+
+    // Regiao em pixels do target; largura/altura 0 = target inteiro.
+    Id subscribe(FrameSink& sink, const sf::IntRect& region = sf::IntRect());
+    void setRegion(Id id, const sf::IntRect& region);
+    void unsubscribe(Id id);
+
+    // Algum inscrito com captura ligada.
+    bool active() const;
+    void capture(sf::RenderTarget& target);
+    // Entrega o frame ainda em voo (PBO) aos inscritos.
+    void flush(sf::RenderTarget& target);
+
+    // Custo medio/maximo de capture() na ultima janela de 1 s.
+    const FrameStats& stats() const { return m_stats; }
+    bool asynchronous() const { return m_grabber.asynchronous(); }
+
+private:
+    struct Subscriber {
+        FrameSink* sink = nullptr;
+        sf::IntRect region;
+        bool wanted = false;   // captura ligada neste frame
+        bool inFlight = false; // ligada quando a leitura em voo foi disparada
+    };
+
+    void deliver(const FrameView& view);
+
+    std::vector<Subscriber> m_subscribers; // indice = Id; nullptr = removido
+    FrameGrabber m_grabber;
+    FrameStats m_stats;
+};
@@ -0,0 +1,354 @@
+#include "CommandLog.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+constexpr char MAGIC[4] = {'V', 'Z', 'C', 'L'};
+constexpr char TRAILER_MAGIC[4] = {'L', 'C', 'Z', 'V'};
+// magic, versao u16, flags u16, seed u32, strings u32, comandos u64,
+// bytes da tabela de strings u64
+constexpr size_t HEADER_SIZE = 32;
+// offset do indice u64, largura da faixa u64, faixas u64, maior tempo i64,
+// reservado u32, magic
+constexpr size_t TRAILER_SIZE = 40;
+constexpr size_t INDEX_ENTRY_SIZE = 32;
+// Faixas com ~256 comandos: seek decodifica pouco e o indice fica pequeno.
+constexpr std::uint64_t RECORDS_PER_BUCKET = 256;
+constexpr std::uint64_t MAX_BUCKETS = 1u << 20;
+
+// Ops conhecidas viram 2 bits da tag; o codigo 3 e op gravada como string.
+const char *const OPS[] = {"INSERT", "REMOVE", "HIGHLIGHT"};
+constexpr unsigned OP_OTHER = 3;
+constexpr unsigned HAS_VALUE = 1u << 2;
+constexpr unsigned TARGET_SHIFT = 3;
+constexpr unsigned TARGET_ESCAPE = 31; // alvo em varint logo depois
+
+void putLE(std::vector<std::uint8_t> &out, std::uint64_t v, size_t bytes) {
+  for (size_t i = 0; i < bytes; ++i)
+    out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+}
+
+void patchLE(std::vector<std::uint8_t> &out, size_t at, std::uint64_t v,
+             size_t bytes) {
+  for (size_t i = 0; i < bytes; ++i)
+    out[at + i] = static_cast<std::uint8_t>(v >> (8 * i));
+}
+
+std::uint64_t getLE(const std::uint8_t *p, size_t bytes) {
+  std::uint64_t v = 0;
+  for (size_t i = 0; i < bytes; ++i)
+    v |= static_cast<std::uint64_t>(p[i]) << (8 * i);
+  return v;
+}
+
+void putVarint(std::vector<std::uint8_t> &out, std::uint64_t v) {
+  while (v >= 0x80) {
+    out.push_back(static_cast<std::uint8_t>(v | 0x80));
+    v >>= 7;
+  }
+  out.push_back(static_cast<std::uint8_t>(v));
+}
+
+bool getVarint(const std::uint8_t *&p, const std::uint8_t *end,
+               std::uint64_t &v) {
+  v = 0;
+  for (unsigned shift = 0; shift < 64 && p < end; shift += 7) {
+    const std::uint8_t b = *p++;
+    v |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+    if (!(b & 0x80))
+      return true;
+  }
+  return false;
+}
+
+std::uint64_t zigzag(std::int64_t v) {
+  return (static_cast<std::uint64_t>(v) << 1) ^
+         static_cast<std::uint64_t>(v >> 63);
+}
+
+std::int64_t unzigzag(std::uint64_t v) {
+  return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+}
+
+std::int64_t toMicros(double seconds) {
+  return static_cast<std::int64_t>(std::llround(seconds * 1e6));
+}
+
+int opCode(const std::string &op) {
+  for (unsigned i = 0; i < OP_OTHER; ++i)
+    if (op == OPS[i])
+      return static_cast<int>(i);
+  return OP_OTHER;
+}
+} // namespace
+
+bool CommandLog::write(const std::string &filePath, unsigned int seed,
+                       const std::vector<RecordedCommand> &commands) {
+  // Alvos e ops desconhecidas sao gravados uma vez na tabela de strings.
+  std::vector<std::string> strings;
+  std::unordered_map<std::string, std::uint64_t> ids;
+  auto intern = [&](const std::string &s) {
+    auto it = ids.find(s);
+    if (it != ids.end())
+      return it->second;
+    ids.emplace(s, strings.size());
+    strings.push_back(s);
+    return static_cast<std::uint64_t>(strings.size() - 1);
+  };
+  std::int64_t endUs = 0;
+  for (const RecordedCommand &c : commands) {
+    intern(c.target);
+    if (opCode(c.op) == static_cast<int>(OP_OTHER))
+      intern(c.op);
+    endUs = std::max(endUs, toMicros(c.t));
+  }
+  const std::uint64_t buckets = std::min<std::uint64_t>(
+      commands.size() / RECORDS_PER_BUCKET + 1, MAX_BUCKETS);
+  const std::uint64_t bucketUs = static_cast<std::uint64_t>(endUs) / buckets + 1;
+
+  std::vector<std::uint8_t> out;
+  out.reserve(HEADER_SIZE + commands.size() * 6 + buckets * INDEX_ENTRY_SIZE +
+              TRAILER_SIZE);
+  out.insert(out.end(), MAGIC, MAGIC + 4);
+  putLE(out, VERSION, 2);
+  putLE(out, 0, 2);
+  putLE(out, seed, 4);
+  putLE(out, strings.size(), 4);
+  putLE(out, commands.size(), 8);
+  putLE(out, 0, 8); // bytes da tabela, preenchido abaixo
+  for (const std::string &s : strings) {
+    putVarint(out, s.size());
+    out.insert(out.end(), s.begin(), s.end());
+  }
+  patchLE(out, 24, out.size() - HEADER_SIZE, 8);
+
+  // A faixa b aponta para o primeiro registro cujo maior tempo visto ate
+  // ali alcanca b * bucketUs; com tempos crescentes, o primeiro da faixa.
+  std::vector<IndexEntry> index;
+  index.reserve(buckets);
+  std::int64_t prevUs = 0, prevIndex = 0, maxUs = 0;
+  for (size_t r = 0; r < commands.size(); ++r) {
+    const RecordedCommand &c = commands[r];
+    const std::int64_t us = toMicros(c.t);
+    maxUs = r == 0 ? us : std::max(maxUs, us);
+    while (index.size() < buckets &&
+           static_cast<std::int64_t>(index.size() * bucketUs) <= maxUs)
+      index.push_back({out.size(), r, prevUs, prevIndex});
+
+    const int op = opCode(c.op);
+    const std::uint64_t target = ids[c.target];
+    unsigned tag = static_cast<unsigned>(op);
+    if (c.hasValue)
+      tag |= HAS_VALUE;
+    tag |= std::min<std::uint64_t>(target, TARGET_ESCAPE) << TARGET_SHIFT;
+    out.push_back(static_cast<std::uint8_t>(tag));
+    if (op == static_cast<int>(OP_OTHER))
+      putVarint(out, ids[c.op]);
+    if (target >= TARGET_ESCAPE)
+      putVarint(out, target);
+    const auto idx = static_cast<std::int64_t>(c.index);
+    putVarint(out, zigzag(us - prevUs));
+    putVarint(out, zigzag(idx - prevIndex));
+    if (c.hasValue)
+      putVarint(out, zigzag(c.value));
+    prevUs = us;
+    prevIndex = idx;
+  }
+  const std::uint64_t indexOffset = out.size();
+  while (index.size() < buckets)
+    index.push_back({indexOffset, commands.size(), prevUs, prevIndex});
+  for (const IndexEntry &e : index) {
+    putLE(out, e.offset, 8);
+    putLE(out, e.record, 8);
+    putLE(out, static_cast<std::uint64_t>(e.prevUs), 8);
+    putLE(out, static_cast<std::uint64_t>(e.prevIndex), 8);
+  }
+  putLE(out, indexOffset, 8);
+  putLE(out, bucketUs, 8);
+  putLE(out, buckets, 8);
+  putLE(out, static_cast<std::uint64_t>(endUs), 8);
+  putLE(out, 0, 4);
+  out.insert(out.end(), TRAILER_MAGIC, TRAILER_MAGIC + 4);
+
+  std::ofstream ofs(filePath, std::ios::binary | std::ios::trunc);
+  if (!ofs)
+    return false;
+  ofs.write(reinterpret_cast<const char *>(out.data()),
+            static_cast<std::streamsize>(out.size()));
+  return static_cast<bool>(ofs);
+}
+
+bool CommandLog::isCommandLog(const std::string &filePath) {
+  std::ifstream ifs(filePath, std::ios::binary);
+  char magic[4] = {};
+  return ifs.read(magic, 4) && std::memcmp(magic, MAGIC, 4) == 0;
+}
+
+bool CommandLog::open(const std::string &filePath) {
+  close();
+  if (!m_file.open(filePath)) {
+    std::cerr << "[CommandLog] Falha ao abrir " << filePath << '\n';
+    return false;
+  }
+  auto fail = [&](const char *why) {
+    std::cerr << "[CommandLog] " << filePath << ": " << why << '\n';
+    close();
+    return false;
+  };
+  const std::uint8_t *d = m_file.data();
+  const size_t size = m_file.size();
+  if (size < HEADER_SIZE + TRAILER_SIZE || std::memcmp(d, MAGIC, 4) != 0)
+    return fail("nao e um log binario de comandos");
+  if (getLE(d + 4, 2) != VERSION)
+    return fail("versao nao suportada");
+  m_seed = static_cast<unsigned int>(getLE(d + 8, 4));
+  const std::uint64_t stringCount = getLE(d + 12, 4);
+  m_count = getLE(d + 16, 8);
+  const std::uint64_t stringBytes = getLE(d + 24, 8);
+
+  const std::uint8_t *t = d + size - TRAILER_SIZE;
+  if (std::memcmp(t + 36, TRAILER_MAGIC, 4) != 0)
+    return fail("rodape invalido (arquivo truncado?)");
+  const std::uint64_t indexOffset = getLE(t, 8);
+  m_bucketUs = getLE(t + 8, 8);
+  m_buckets = getLE(t + 16, 8);
+  m_endUs = static_cast<std::int64_t>(getLE(t + 24, 8));
+  const size_t indexEnd = size - TRAILER_SIZE;
+  if (stringBytes > size || HEADER_SIZE + stringBytes > indexOffset ||
+      indexOffset > indexEnd || m_bucketUs == 0 || m_buckets == 0 ||
+      m_buckets > (indexEnd - indexOffset) / INDEX_ENTRY_SIZE ||
+      indexOffset + m_buckets * INDEX_ENTRY_SIZE != indexEnd)
+    return fail("cabecalho ou indice inconsistente");
+  // Cada registro tem ao menos 3 bytes (tag, tempo e indice).
+  if (m_count > (indexOffset - HEADER_SIZE - stringBytes) / 3)
+    return fail("quantidade de comandos maior que o arquivo");
+
+  // Cada string tem ao menos o byte do tamanho: limita o reserve abaixo.
+  if (stringCount > stringBytes)
+    return fail("tabela de strings corrompida");
+
+  const std::uint8_t *p = d + HEADER_SIZE;
+  const std::uint8_t *stringsEnd = p + stringBytes;
+  m_strings.reserve(stringCount);
+  for (std::uint64_t i = 0; i < stringCount; ++i) {
+    std::uint64_t len = 0;
+    if (!getVarint(p, stringsEnd, len) ||
+        len > static_cast<std::uint64_t>(stringsEnd - p))
+      return fail("tabela de strings corrompida");
+    m_strings.emplace_back(reinterpret_cast<const char *>(p), len);
+    p += len;
+  }
+  if (p != stringsEnd)
+    return fail("tabela de strings corrompida");
+  m_records = stringsEnd;
+  m_index = d + indexOffset;
+  return true;
+}
+
+void CommandLog::close() {
+  m_file.close();
+  m_strings.clear();
+  m_records = m_index = nullptr;
+  m_count = 0;
+  m_bucketUs = 1;
+  m_buckets = 0;
+  m_endUs = 0;
+  m_seed = 0;
+}
+
+CommandLog::Cursor CommandLog::begin() const {
+  Cursor c;
+  c.m_log = this;
+  c.m_pos = m_records;
+  c.m_end = m_index;
+  return c;
+}
+
+CommandLog::IndexEntry CommandLog::indexEntry(std::uint64_t bucket) const {
+  const std::uint8_t *p = m_index + bucket * INDEX_ENTRY_SIZE;
+  return {getLE(p, 8), getLE(p + 8, 8),
+          static_cast<std::int64_t>(getLE(p + 16, 8)),
+          static_cast<std::int64_t>(getLE(p + 24, 8))};
+}
+
+CommandLog::Cursor CommandLog::seek(double seconds) const {
+  Cursor c = begin();
+  if (!isOpen())
+    return c;
+  const std::int64_t target = toMicros(seconds);
+  if (target > 0) {
+    const std::uint64_t bucket = std::min<std::uint64_t>(
+        static_cast<std::uint64_t>(target) / m_bucketUs, m_buckets - 1);
+    const IndexEntry e = indexEntry(bucket);
+    const std::uint8_t *base = m_file.data();
+    if (e.offset < static_cast<std::uint64_t>(m_records - base) ||
+        e.offset > static_cast<std::uint64_t>(m_index - base) ||
+        e.record > m_count) {
+      c.m_failed = true;
+      return c;
+    }
+    c.m_pos = base + e.offset;
+    c.m_record = e.record;
+    c.m_prevUs = e.prevUs;
+    c.m_prevIndex = e.prevIndex;
+  }
+  // Dentro da faixa, anda ate o primeiro comando que alcanca o tempo.
+  RecordedCommand skipped;
+  for (;;) {
+    Cursor at = c;
+    std::int64_t us = 0;
+    if (!c.decode(skipped, us) || us >= target)
+      return c.m_failed ? c : at;
+  }
+}
+
+bool CommandLog::Cursor::next(RecordedCommand &out) {
+  std::int64_t us = 0;
+  return decode(out, us);
+}
+
+bool CommandLog::Cursor::decode(RecordedCommand &out, std::int64_t &timeUs) {
+  if (!m_log || m_failed || m_record >= m_log->m_count)
+    return false;
+  auto fail = [this] {
+    m_failed = true;
+    return false;
+  };
+  if (m_pos >= m_end)
+    return fail();
+  const std::vector<std::string> &strings = m_log->m_strings;
+  const unsigned tag = *m_pos++;
+  const unsigned op = tag & 3u;
+  std::uint64_t opId = 0, target = tag >> TARGET_SHIFT, dt = 0, di = 0,
+                value = 0;
+  if (op == OP_OTHER && (!getVarint(m_pos, m_end, opId) || opId >= strings.size()))
+    return fail();
+  if (target == TARGET_ESCAPE && !getVarint(m_pos, m_end, target))
+    return fail();
+  if (target >= strings.size() || !getVarint(m_pos, m_end, dt) ||
+      !getVarint(m_pos, m_end, di))
+    return fail();
+  const bool hasValue = (tag & HAS_VALUE) != 0;
+  if (hasValue && !getVarint(m_pos, m_end, value))
+    return fail();
+  const std::int64_t index = m_prevIndex + unzigzag(di);
+  const std::int64_t v = hasValue ? unzigzag(value) : 0;
+  if (index < 0 || v < INT32_MIN || v > INT32_MAX)
+    return fail();
+
+  m_prevUs += unzigzag(dt);
+  m_prevIndex = index;
+  ++m_record;
+  timeUs = m_prevUs;
+  out.op = op == OP_OTHER ? strings[opId] : OPS[op];
+  out.target = strings[target];
+  out.index = static_cast<size_t>(index);
+  out.value = static_cast<int>(v);
+  out.hasValue = hasValue;
+  out.t = m_prevUs / 1e6;
+  return true;
+}
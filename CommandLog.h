@@ -0,0 +1,86 @@
+#pragma once
+#include "CommandRecorder.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Log de comandos binario e versionado (.cmdlog), lido direto do mmap.
+//
+//   cabecalho   "VZCL", versao, seed, quantidade de comandos e a tabela de
+//               strings (alvos e ops fora do enum), cada uma gravada uma vez
+//   registros   tag (op em 2 bits, tem valor, alvo em 5 bits) seguida de
+//               varints zigzag: delta do tempo em microssegundos, delta do
+//               indice e, se houver, o valor
+//   indice      por faixa de tempo de largura fixa: offset, numero e estado
+//               do decodificador (tempo/indice anteriores) do primeiro
+//               registro que alcanca a faixa
+//   rodape      onde esta o indice, largura/quantidade de faixas e "LCZV"
+//
+// open() so valida cabecalho e rodape e le a tabela de strings; os
+// registros sao decodificados sob demanda por um Cursor. seek() vai pelo
+// indice direto para a faixa e decodifica no maximo uma faixa. Texto e JSON
+// continuam como formatos de importacao/exportacao.
+class CommandLog {
+public:
+    static constexpr std::uint16_t VERSION = 1;
+
+    class Cursor {
+    public:
+        // false no fim ou se o registro estiver corrompido (ver failed()).
+        bool next(RecordedCommand& out);
+        bool failed() const { return m_failed; }
+        // Numero do proximo registro (0 = o primeiro).
+        std::uint64_t position() const { return m_record; }
+
+    private:
+        friend class CommandLog;
+        bool decode(RecordedCommand& out, std::int64_t& timeUs);
+
+        const CommandLog* m_log = nullptr;
+        const std::uint8_t* m_pos = nullptr;
+        const std::uint8_t* m_end = nullptr;
+        std::uint64_t m_record = 0;
+        std::int64_t m_prevUs = 0;
+        std::int64_t m_prevIndex = 0;
+        bool m_failed = false;
+    };
+
+    bool open(const std::string& filePath);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    std::uint64_t size() const { return m_count; }
+    unsigned int seed() const { return m_seed; }
+    // Maior timestamp gravado, em segundos.
+    double duration() const { return m_endUs / 1e6; }
+
+    Cursor begin() const;
+    // Cursor no primeiro comando com t >= seconds (na ordem do arquivo).
+    Cursor seek(double seconds) const;
+
+    static bool write(const std::string& filePath, unsigned int seed,
+                      const std::vector<RecordedCommand>& commands);
+    // So confere o magic, sem mapear o arquivo.
+    static bool isCommandLog(const std::string& filePath);
+
+private:
+    struct IndexEntry {
+        std::uint64_t offset;
+        std::uint64_t record;
+        std::int64_t prevUs;
+        std::int64_t prevIndex;
+    };
+
+    IndexEntry indexEntry(std::uint64_t bucket) const;
+
+    MappedFile m_file;
+    std::vector<std::string> m_strings;
+    const std::uint8_t* m_records = nullptr;
+    const std::uint8_t* m_index = nullptr;
+    std::uint64_t m_count = 0;
+    std::uint64_t m_bucketUs = 1;
+    std::uint64_t m_buckets = 0;
+    std::int64_t m_endUs = 0;
+    unsigned int m_seed = 0;
+};
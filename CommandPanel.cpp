@@ -0,0 +1,98 @@
+#include "CommandPanel.h"
+#include <algorithm>
+
+CommandPanel::CommandPanel(const sf::Font &font, float width)
+    : m_font(font), m_width(width), m_title("Fila de Comandos Pendentes", font, 20),
+      m_stats("", font, 14) {
+  m_background.setFillColor(sf::Color(20, 20, 20, 200));
+  m_title.setFillColor(sf::Color::White);
+  m_stats.setFillColor(sf::Color(180, 180, 180));
+}
+
+bool CommandPanel::setRow(size_t row, const std::string &label, float x,
+                          float y) {
+  if (row >= m_rows.size()) {
+    m_rows.push_back(Row{std::string(), sf::Text("", m_font, 16)});
+    m_rows.back().text.setFillColor(sf::Color(220, 220, 220));
+  }
+  Row &r = m_rows[row];
+  bool changed = false;
+  if (r.label != label) {
+    r.label = label;
+    r.text.setString(label);
+    changed = true;
+  }
+  if (r.text.getPosition() != sf::Vector2f(x, y)) {
+    r.text.setPosition(x, y);
+    changed = true;
+  }
+  return changed;
+}
+
+bool CommandPanel::sync(const std::deque<Command> &first,
+                        const std::deque<Command> &second,
+                        sf::Vector2u targetSize) {
+  bool changed = false;
+  float panelX = static_cast<float>(targetSize.x) - m_width;
+  if (targetSize != m_targetSize) {
+    m_targetSize = targetSize;
+    m_background.setSize({m_width, static_cast<float>(targetSize.y)});
+    m_background.setPosition(panelX, 0);
+    m_title.setPosition(panelX + 15, 15);
+    m_stats.setPosition(panelX + 15, targetSize.y - 30.f);
+    changed = true;
+  }
+
+  size_t total = first.size() + second.size();
+  if (total != m_statsTotal) {
+    m_statsTotal = total;
+    m_stats.setString("Pendentes: " + std::to_string(total));
+    changed = true;
+  }
+
+  float usable = static_cast<float>(targetSize.y) - FIRST_ROW_Y - FOOTER_HEIGHT;
+  size_t capacity =
+      std::max<size_t>(1, static_cast<size_t>(std::max(0.f, usable) / ROW_HEIGHT));
+  size_t rows = 0;
+  float x = panelX + 15;
+  auto rowY = [](size_t r) { return FIRST_ROW_Y + static_cast<float>(r) * ROW_HEIGHT; };
+
+  if (total == 0) {
+    changed |= setRow(rows, "(vazio)", x, rowY(rows));
+    ++rows;
+  } else {
+    // Com excedentes, a ultima linha vira o contador "+N".
+    size_t shown = total <= capacity ? total : capacity - 1;
+    auto emit = [&](const std::deque<Command> &queue) {
+      for (auto it = queue.begin(); it != queue.end() && rows < shown; ++it) {
+        changed |= setRow(rows, it->description, x, rowY(rows));
+        ++rows;
+      }
+    };
+    emit(first);
+    emit(second);
+    if (shown < total) {
+      size_t extra = total - shown;
+      if (extra != m_overflow) {
+        m_overflow = extra;
+        m_overflowLabel = "... +" + std::to_string(extra) + " comandos";
+      }
+      changed |= setRow(rows, m_overflowLabel, x, rowY(rows));
+      ++rows;
+    }
+  }
+
+  if (rows != m_visibleRows) {
+    m_visibleRows = rows;
+    changed = true;
+  }
+  return changed;
+}
+
+void CommandPanel::draw(sf::RenderTarget &target) const {
+  target.draw(m_background);
+  target.draw(m_title);
+  for (size_t i = 0; i < m_visibleRows; ++i)
+    target.draw(m_rows[i].text);
+  target.draw(m_stats);
+}
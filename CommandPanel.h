@@ -0,0 +1,45 @@
+#pragma once
+#include "Command.h"
+#include <SFML/Graphics.hpp>
+#include <deque>
+#include <string>
+#include <vector>
+
+// Painel lateral com as filas de comandos pendentes. Le as filas no lugar,
+// desenha apenas as linhas que cabem na altura disponivel (mais um contador
+// de excedentes) e reaproveita os sf::Text de cada linha entre frames.
+class CommandPanel {
+public:
+    explicit CommandPanel(const sf::Font& font, float width = 280.f);
+
+    // Atualiza as linhas visiveis; retorna true se algo visivel mudou.
+    bool sync(const std::deque<Command>& first, const std::deque<Command>& second,
+              sf::Vector2u targetSize);
+    void draw(sf::RenderTarget& target) const;
+
+    float width() const { return m_width; }
+
+private:
+    struct Row {
+        std::string label;
+        sf::Text text;
+    };
+
+    bool setRow(size_t row, const std::string& label, float x, float y);
+
+    const sf::Font& m_font;
+    float m_width;
+    sf::Vector2u m_targetSize;
+    sf::RectangleShape m_background;
+    sf::Text m_title;
+    sf::Text m_stats;
+    size_t m_statsTotal = static_cast<size_t>(-1);
+    std::vector<Row> m_rows;
+    size_t m_visibleRows = 0;
+    size_t m_overflow = 0;
+    std::string m_overflowLabel;
+
+    static constexpr float FIRST_ROW_Y = 60.f;
+    static constexpr float ROW_HEIGHT = 25.f;
+    static constexpr float FOOTER_HEIGHT = 40.f;
+};
@@ -1,7 +1,12 @@
 #include "CommandRecorder.h"
+#include "CommandLog.h"
+#include "JsonSax.h"
+#include "MappedFile.h"
 #include <chrono>
 #include <iomanip>
 #include <algorithm>
+#include <charconv>
+#include <iostream>
 
 static double nowSeconds() {
     using namespace std::chrono;
@@ -86,47 +91,150 @@ bool CommandRecorder::saveJSON(const std::string& filePath) const {
     return true;
 }
 
+namespace {
+// Eventos do JSON de saveJSON: array no topo com um objeto por comando (o
+// META traz a seed). Chaves desconhecidas sao ignoradas, inclusive com
+// valores aninhados; tipo errado numa chave conhecida e erro.
+class CommandJsonHandler : public JsonSaxHandler {
+public:
+    CommandJsonHandler(std::vector<RecordedCommand>& out, unsigned int& seed) : m_out(out), m_seed(seed) {}
+
+    bool monotonic() const { return m_monotonic; }
+
+    const char* startArray() override {
+        if (m_depth == 0) { ++m_depth; return nullptr; }
+        return nested();
+    }
+    const char* endArray() override { --m_depth; return nullptr; }
+    const char* startObject() override {
+        if (m_depth == 0) return "esperado um array de comandos";
+        if (m_depth == 1) {
+            m_cmd = RecordedCommand();
+            m_isMeta = false;
+            ++m_depth;
+            return nullptr;
+        }
+        return nested();
+    }
+    const char* endObject() override {
+        if (--m_depth != 1) return nullptr;
+        if (m_isMeta || m_cmd.op.empty()) return nullptr;
+        if (!m_out.empty() && m_cmd.t < m_out.back().t) m_monotonic = false;
+        m_out.push_back(std::move(m_cmd));
+        return nullptr;
+    }
+    const char* key(std::string_view k) override {
+        if (m_depth != 2) return nullptr;
+        m_key = k == "op"      ? Key::Op
+              : k == "target"  ? Key::Target
+              : k == "index"   ? Key::Index
+              : k == "value"   ? Key::Value
+              : k == "t"       ? Key::Time
+              : k == "seed"    ? Key::Seed
+              : k == "META"    ? Key::Meta
+                               : Key::Other; // "version" e extras
+        if (m_key == Key::Meta) m_isMeta = true;
+        return nullptr;
+    }
+    const char* string(std::string_view v) override {
+        if (m_depth == 1) return "esperado um objeto de comando";
+        if (m_depth != 2) return nullptr;
+        if (m_key == Key::Op) m_cmd.op.assign(v);
+        else if (m_key == Key::Target) m_cmd.target.assign(v);
+        else if (m_key != Key::Other && m_key != Key::Meta) return "esperado um numero";
+        return nullptr;
+    }
+    const char* number(std::string_view v) override {
+        if (m_depth == 1) return "esperado um objeto de comando";
+        if (m_depth != 2) return nullptr;
+        switch (m_key) {
+        case Key::Index: return parse(v, m_cmd.index, "index deve ser inteiro nao negativo");
+        case Key::Value:
+            m_cmd.hasValue = true;
+            return parse(v, m_cmd.value, "value deve ser inteiro de 32 bits");
+        case Key::Time: return parse(v, m_cmd.t, "t invalido");
+        case Key::Seed: return parse(v, m_seed, "seed deve ser inteiro de 32 bits sem sinal");
+        case Key::Op:
+        case Key::Target: return "esperada uma string";
+        default: return nullptr;
+        }
+    }
+    const char* boolean(bool) override { return scalar(); }
+    const char* null() override { return scalar(); }
+
+private:
+    enum class Key { Op, Target, Index, Value, Time, Seed, Meta, Other };
+
+    template <typename T>
+    static const char* parse(std::string_view v, T& out, const char* error) {
+        const char* end = v.data() + v.size();
+        auto [ptr, ec] = std::from_chars(v.data(), end, out);
+        return ec == std::errc() && ptr == end ? nullptr : error;
+    }
+    // Array/objeto como valor: so aceito em chaves que o loader ignora.
+    const char* nested() {
+        if (m_depth == 1) return "esperado um objeto de comando";
+        if (m_depth == 2 && m_key != Key::Other && m_key != Key::Meta) return "valor nao pode ser array/objeto";
+        ++m_depth;
+        return nullptr;
+    }
+    const char* scalar() {
+        if (m_depth == 1) return "esperado um objeto de comando";
+        if (m_depth == 2 && m_key != Key::Other && m_key != Key::Meta) return "tipo invalido para a chave";
+        return nullptr;
+    }
+
+    std::vector<RecordedCommand>& m_out;
+    unsigned int& m_seed;
+    RecordedCommand m_cmd;
+    Key m_key = Key::Other;
+    size_t m_depth = 0;
+    bool m_isMeta = false;
+    bool m_monotonic = true;
+};
+} // namespace
+
 bool CommandRecorder::loadJSON(const std::string& filePath) {
-    std::ifstream ifs(filePath);
-    if (!ifs) return false;
-    std::stringstream buffer; buffer << ifs.rdbuf();
-    std::string content = buffer.str();
+    // Uma passada sobre o arquivo mapeado: sem copia para string, sem arvore.
+    MappedFile file;
+    if (!file.open(filePath, true)) return false;
+    const std::string_view input(reinterpret_cast<const char*>(file.data()), file.size());
     m_commands.clear();
-    size_t pos = 0;
-    while ((pos = content.find('{', pos)) != std::string::npos) {
-        size_t end = content.find('}', pos);
-        if (end == std::string::npos) break;
-        std::string obj = content.substr(pos + 1, end - pos - 1);
-        RecordedCommand rc; rc.index = 0; rc.value = 0; rc.hasValue = false; rc.t = 0.0;
-        std::istringstream iss(obj);
-        std::string part;
-        bool isMeta = false;
-        while (std::getline(iss, part, ',')) {
-            auto colon = part.find(':');
-            if (colon == std::string::npos) continue;
-            std::string key = part.substr(0, colon);
-            std::string val = part.substr(colon + 1);
-            auto trimQuotes = [](std::string s){
-                s.erase(0, s.find_first_not_of(" \""));
-                s.erase(s.find_last_not_of(" \"") + 1);
-                return s;
-            };
-            key = trimQuotes(key);
-            val = trimQuotes(val);
-            if (key == "META") { isMeta = true; }
-            else if (key == "version") { /* ignorado por enquanto */ }
-            else if (key == "seed") { m_seed = static_cast<unsigned int>(std::stoul(val)); }
-            else if (key == "op") rc.op = val;
-            else if (key == "target") rc.target = val;
-            else if (key == "index") rc.index = static_cast<size_t>(std::stoul(val));
-            else if (key == "value") { rc.value = std::stoi(val); rc.hasValue = true; }
-            else if (key == "t") rc.t = std::stod(val);
-        }
-        if (!isMeta && !rc.op.empty()) m_commands.push_back(rc);
-        pos = end + 1;
+    // saveJSON gasta ~70 bytes por comando; evita realocacoes no caminho.
+    m_commands.reserve(file.size() / 64);
+    CommandJsonHandler handler(m_commands, m_seed);
+    JsonSaxParser parser;
+    if (!parser.parse(input, handler)) {
+        const JsonError& e = parser.error();
+        std::cerr << "[CommandRecorder] " << filePath << ':' << e.line << ':' << e.column
+                  << ": " << e.message << " (byte " << e.offset << ")" << '\n';
+        m_commands.clear();
+        return false;
     }
+    // Logs gravados pelo recorder ja vem em ordem; so ordena o que nao vem.
+    // stable_sort mantem a ordem do arquivo entre comandos no mesmo instante.
+    if (!handler.monotonic())
+        std::stable_sort(m_commands.begin(), m_commands.end(), [](const RecordedCommand& a, const RecordedCommand& b){ return a.t < b.t; });
+    return true;
+}
 
-    std::sort(m_commands.begin(), m_commands.end(), [](const RecordedCommand& a, const RecordedCommand& b){ return a.t < b.t; });
+bool CommandRecorder::saveBinary(const std::string& filePath) const {
+    return CommandLog::write(filePath, m_seed, m_commands);
+}
 
+bool CommandRecorder::loadBinary(const std::string& filePath, double fromSeconds) {
+    CommandLog log;
+    if (!log.open(filePath)) return false;
+    CommandLog::Cursor cursor = fromSeconds > 0.0 ? log.seek(fromSeconds) : log.begin();
+    m_seed = log.seed();
+    m_commands.clear();
+    m_commands.reserve(static_cast<size_t>(log.size() - std::min(log.size(), cursor.position())));
+    RecordedCommand rc;
+    while (cursor.next(rc)) m_commands.push_back(rc);
+    if (cursor.failed()) {
+        std::cerr << "[CommandRecorder] " << filePath << " corrompido apos "
+                  << cursor.position() << " comandos" << '\n';
+        return false;
+    }
     return true;
 }
@@ -30,7 +30,13 @@ public:
     bool save(const std::string& filePath) const;
     bool load(const std::string& filePath);
     bool saveJSON(const std::string& filePath) const;
+    // Parser SAX direto do arquivo mapeado; erro de sintaxe sai com
+    // linha:coluna no stderr e a lista fica vazia.
     bool loadJSON(const std::string& filePath);
+    // Formato binario compacto (CommandLog, .cmdlog). fromSeconds > 0 usa o
+    // indice do arquivo e so decodifica os comandos a partir desse tempo.
+    bool saveBinary(const std::string& filePath) const;
+    bool loadBinary(const std::string& filePath, double fromSeconds = 0.0);
 
     static std::optional<RecordedCommand> parseLine(const std::string& line);
 
@@ -0,0 +1,572 @@
+#include "CompressedFrameStore.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <random>
+
+namespace {
+// Runs menores que isso saem mais baratos como literais.
+constexpr size_t MIN_RUN = 4;
+
+inline std::uint32_t loadWord(const std::uint8_t *base, size_t i) {
+  std::uint32_t v;
+  std::memcpy(&v, base + i * 4, 4);
+  return v;
+}
+
+inline void storeWord(std::uint8_t *base, size_t i, std::uint32_t v) {
+  std::memcpy(base + i * 4, &v, 4);
+}
+
+void writeVarint(std::vector<std::uint8_t> &out, std::uint64_t v) {
+  while (v >= 0x80) {
+    out.push_back(static_cast<std::uint8_t>(v | 0x80));
+    v >>= 7;
+  }
+  out.push_back(static_cast<std::uint8_t>(v));
+}
+
+std::uint64_t readVarint(const std::uint8_t *&p) {
+  std::uint64_t v = 0;
+  for (int shift = 0;; shift += 7) {
+    std::uint8_t b = *p++;
+    v |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+    if (!(b & 0x80))
+      return v;
+  }
+}
+} // namespace
+
+std::uint64_t CompressedFrameStore::newGeneration() {
+  // Aleatorio + relogio + contador: distinto entre stores, clears e
+  // processos.
+  static std::atomic<std::uint64_t> counter{0};
+  std::random_device rd;
+  std::uint64_t g = (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+  g ^= static_cast<std::uint64_t>(
+      std::chrono::steady_clock::now().time_since_epoch().count());
+  g ^= ++counter * 0x9E3779B97F4A7C15ull;
+  return g ? g : 1;
+}
+
+CompressedFrameStore::~CompressedFrameStore() {
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  if (m_worker.joinable())
+    m_worker.join();
+}
+
+void CompressedFrameStore::push(RawFrame &frame, size_t repeat) {
+  if (frame.empty() || repeat == 0)
+    return;
+  std::unique_lock<std::mutex> lk(m_mutex);
+  if (!m_worker.joinable())
+    m_worker = std::thread(&CompressedFrameStore::workerLoop, this);
+  m_cv.wait(lk, [this] { return m_queue.size() < QUEUE_DEPTH; });
+  m_queue.emplace_back(std::move(frame), repeat);
+  frame = RawFrame();
+  if (!m_pool.empty()) {
+    frame = std::move(m_pool.back());
+    m_pool.pop_back();
+  }
+  m_cv.notify_all();
+}
+
+void CompressedFrameStore::waitIdle() const {
+  std::unique_lock<std::mutex> lk(m_mutex);
+  m_cv.wait(lk, [this] { return m_queue.empty() && !m_busy; });
+}
+
+bool CompressedFrameStore::clear() {
+  waitIdle();
+  std::lock_guard<std::mutex> lk(m_mutex);
+  if (!m_pins.empty())
+    return false;
+  // Ids continuam crescendo: snapshots antigos deixam de achar seus frames.
+  // A geracao nova diz a quem exportou antes que a sessao recomecou.
+  m_firstId += m_frames.size();
+  m_generation = newGeneration();
+  m_frames.clear();
+  m_used = 0;
+  m_raw = 0;
+  m_captures = 0;
+  m_dropped = 0;
+  m_full = false;
+  m_forceKey = true;
+  m_spillHead = 0;
+  m_spilledCount = 0;
+  m_spillLive = 0;
+  m_spillLimit = m_spill.capacity();
+  return true;
+}
+
+bool CompressedFrameStore::enableSpill(size_t diskBytes) {
+  if (!clear())
+    return false;
+  std::lock_guard<std::mutex> lk(m_mutex);
+  const bool ok = m_spill.open(diskBytes);
+  m_spillLimit = m_spill.capacity();
+  return ok;
+}
+
+bool CompressedFrameStore::spilling() const {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  return m_spill.isOpen();
+}
+
+size_t CompressedFrameStore::spilledBytes() const {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  return m_spillLive;
+}
+
+size_t CompressedFrameStore::spillCapacity() const {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  return m_spillLimit;
+}
+
+void CompressedFrameStore::setCircular(bool circular) {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  m_circular = circular;
+  m_full = false;
+}
+
+void CompressedFrameStore::setWindow(size_t ticks) {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  m_window = ticks;
+  trimWindowLocked();
+}
+
+void CompressedFrameStore::setBudget(size_t bytes) {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  m_budget = bytes;
+  if (m_spill.isOpen()) {
+    // O orcamento e so a janela em RAM; o excedente vai para o disco.
+    spillLocked();
+    return;
+  }
+  // Sem modo circular mantem os frames antigos, como um limite de contagem.
+  if (m_circular)
+    evictLocked();
+  m_full = !m_circular && m_used > m_budget;
+}
+
+size_t CompressedFrameStore::usedBytes() const {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  return m_used;
+}
+
+size_t CompressedFrameStore::rawBytes() const {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  return m_raw;
+}
+
+bool CompressedFrameStore::full() const {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  return m_full;
+}
+
+size_t CompressedFrameStore::droppedFrames() const {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  return m_dropped;
+}
+
+size_t CompressedFrameStore::captureCount() const {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  return m_captures;
+}
+
+size_t CompressedFrameStore::frameRepeat(size_t index) const {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  return index < m_frames.size() ? m_frames[index].repeat : 0;
+}
+
+size_t CompressedFrameStore::frameId(size_t index) const {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  return m_firstId + index;
+}
+
+std::uint64_t CompressedFrameStore::generation() const {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  return m_generation;
+}
+
+size_t CompressedFrameStore::frameCount() const {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  return m_frames.size();
+}
+
+void CompressedFrameStore::workerLoop() {
+  while (true) {
+    RawFrame frame;
+    size_t repeat = 1;
+    bool key = false;
+    bool canRepeat = false;
+    {
+      std::unique_lock<std::mutex> lk(m_mutex);
+      m_cv.wait(lk, [this] { return !m_queue.empty() || m_stop; });
+      if (m_queue.empty())
+        return;
+      frame = std::move(m_queue.front().first);
+      repeat = m_queue.front().second;
+      m_queue.pop_front();
+      m_busy = true;
+      key = m_forceKey || m_sinceKey >= KEY_INTERVAL ||
+            frame.width != m_previous.width ||
+            frame.height != m_previous.height;
+      // So pode repetir se o ultimo frame guardado e m_previous.
+      canRepeat = !m_forceKey && !m_full && !m_frames.empty() &&
+                  frame.width == m_previous.width &&
+                  frame.height == m_previous.height;
+      m_forceKey = false;
+    }
+
+    // memcmp ja usa SIMD na libc e para no primeiro byte diferente.
+    if (canRepeat && std::memcmp(frame.pixels.data(), m_previous.pixels.data(),
+                                 frame.bytes()) == 0) {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      Encoded &last = m_frames.back();
+      last.repeat += repeat;
+      m_raw += frame.bytes() * repeat;
+      m_captures += repeat;
+      trimWindowLocked();
+      m_pool.push_back(std::move(frame));
+      m_busy = false;
+      m_cv.notify_all();
+      continue;
+    }
+
+    encode(frame, key, m_scratch);
+    Encoded enc;
+    enc.data.assign(m_scratch.begin(), m_scratch.end());
+    enc.size = enc.data.size();
+    enc.width = frame.width;
+    enc.height = frame.height;
+    enc.key = key;
+    enc.repeat = repeat;
+    m_sinceKey = key ? 1 : m_sinceKey + 1;
+    // O frame atual vira referencia do proximo delta; o antigo volta ao pool.
+    std::swap(m_previous, frame);
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    append(std::move(enc));
+    if (!frame.empty())
+      m_pool.push_back(std::move(frame));
+    m_busy = false;
+    m_cv.notify_all();
+  }
+}
+
+void CompressedFrameStore::encode(const RawFrame &frame, bool key,
+                                  std::vector<std::uint8_t> &out) const {
+  out.clear();
+  const std::uint8_t *cur = frame.pixels.data();
+  const std::uint8_t *prev = m_previous.pixels.data();
+  const size_t n = static_cast<size_t>(frame.width) * frame.height;
+  auto word = [&](size_t i) {
+    std::uint32_t v = loadWord(cur, i);
+    return key ? v : v ^ loadWord(prev, i);
+  };
+  auto emitLiteral = [&](size_t first, size_t last) {
+    if (first == last)
+      return;
+    writeVarint(out, static_cast<std::uint64_t>(last - first) << 1);
+    const size_t at = out.size();
+    out.resize(at + (last - first) * 4);
+    for (size_t i = first; i < last; ++i)
+      storeWord(out.data() + at, i - first, word(i));
+  };
+
+  size_t literalStart = 0;
+  size_t i = 0;
+  while (i < n) {
+    const std::uint32_t v = word(i);
+    size_t j = i + 1;
+    while (j < n && word(j) == v)
+      ++j;
+    if (j - i >= MIN_RUN) {
+      emitLiteral(literalStart, i);
+      writeVarint(out, (static_cast<std::uint64_t>(j - i) << 1) | 1);
+      const size_t at = out.size();
+      out.resize(at + 4);
+      storeWord(out.data() + at, 0, v);
+      literalStart = j;
+    }
+    i = j;
+  }
+  emitLiteral(literalStart, n);
+}
+
+void CompressedFrameStore::decode(const Encoded &enc, const std::uint8_t *data,
+                                  RawFrame &out) {
+  if (enc.key || out.width != enc.width || out.height != enc.height)
+    out.resize(enc.width, enc.height);
+  std::uint8_t *dst = out.pixels.data();
+  const std::uint8_t *p = data;
+  const std::uint8_t *end = p + enc.size;
+  size_t i = 0;
+  while (p < end) {
+    const std::uint64_t header = readVarint(p);
+    const size_t count = static_cast<size_t>(header >> 1);
+    if (header & 1) {
+      std::uint32_t v;
+      std::memcpy(&v, p, 4);
+      p += 4;
+      if (enc.key) {
+        for (size_t k = 0; k < count; ++k)
+          storeWord(dst, i + k, v);
+      } else if (v != 0) {
+        for (size_t k = 0; k < count; ++k)
+          storeWord(dst, i + k, loadWord(dst, i + k) ^ v);
+      }
+    } else if (enc.key) {
+      std::memcpy(dst + i * 4, p, count * 4);
+      p += count * 4;
+    } else {
+      for (size_t k = 0; k < count; ++k, p += 4) {
+        std::uint32_t v;
+        std::memcpy(&v, p, 4);
+        storeWord(dst, i + k, loadWord(dst, i + k) ^ v);
+      }
+    }
+    i += count;
+  }
+}
+
+const std::uint8_t *CompressedFrameStore::bytesOf(const Encoded &enc) const {
+  return enc.offset == NOT_SPILLED ? enc.data.data()
+                                   : m_spill.data() + enc.offset;
+}
+
+void CompressedFrameStore::append(Encoded enc) {
+  enc.size = enc.data.size();
+  const size_t cost = enc.size + sizeof(Encoded);
+  const bool overBudget = !m_spill.isOpen() && m_used + cost > m_budget;
+  if (!m_circular && (m_full || overBudget)) {
+    // Cheio: descarta este e os seguintes, sem buracos na sequencia.
+    m_full = true;
+    ++m_dropped;
+    m_forceKey = true;
+    return;
+  }
+  m_used += cost;
+  m_raw += static_cast<size_t>(enc.width) * enc.height * 4 * enc.repeat;
+  m_captures += enc.repeat;
+  m_frames.push_back(std::move(enc));
+  trimWindowLocked();
+  if (!m_spill.isOpen()) {
+    evictLocked();
+    return;
+  }
+  if (!spillLocked()) {
+    // Disco cheio no modo linear: desfaz este e passa a descartar.
+    const Encoded &back = m_frames.back();
+    m_used -= back.size + sizeof(Encoded);
+    m_raw -= static_cast<size_t>(back.width) * back.height * 4 * back.repeat;
+    m_captures -= back.repeat;
+    m_frames.pop_back();
+    m_full = true;
+    ++m_dropped;
+    m_forceKey = true;
+  }
+}
+
+size_t CompressedFrameStore::frontGop(size_t &ticks) const {
+  // Tamanho do primeiro GOP; 0 se ele e o unico (o atual nunca sai).
+  ticks = m_frames.empty() ? 0 : m_frames.front().repeat;
+  size_t gop = 1;
+  while (gop < m_frames.size() && !m_frames[gop].key)
+    ticks += m_frames[gop++].repeat;
+  return gop < m_frames.size() ? gop : 0;
+}
+
+bool CompressedFrameStore::popFrontGop() {
+  size_t ticks = 0;
+  const size_t gop = frontGop(ticks);
+  if (gop == 0)
+    return false;
+  // Faixas de snapshots vivos ficam.
+  if (!m_pins.empty() && m_firstId + gop > *m_pins.begin())
+    return false;
+  for (size_t k = 0; k < gop; ++k) {
+    const Encoded &front = m_frames.front();
+    if (front.offset != NOT_SPILLED) {
+      m_used -= sizeof(Encoded);
+      m_spillLive -= front.size;
+      --m_spilledCount;
+    } else {
+      m_used -= front.size + sizeof(Encoded);
+    }
+    m_raw -= static_cast<size_t>(front.width) * front.height * 4 * front.repeat;
+    m_captures -= front.repeat;
+    m_frames.pop_front();
+  }
+  m_firstId += gop;
+  return true;
+}
+
+void CompressedFrameStore::trimWindowLocked() {
+  if (!m_circular || m_window == 0)
+    return;
+  size_t ticks = 0;
+  while (frontGop(ticks) > 0 && m_captures - ticks >= m_window &&
+         popFrontGop()) {
+  }
+}
+
+void CompressedFrameStore::evictLocked() {
+  // Remove GOPs inteiros (keyframe + deltas) do inicio; o GOP atual fica.
+  while (m_used > m_budget && popFrontGop()) {
+  }
+}
+
+bool CompressedFrameStore::spillLocked() {
+  // Move os registros mais antigos ainda em RAM para o arquivo, em ordem.
+  // O mais novo fica sempre em RAM. No modo circular o arquivo e um anel e
+  // os GOPs que seriam sobrescritos saem do store.
+  while (m_used > m_budget && m_spilledCount + 1 < m_frames.size()) {
+    const size_t size = m_frames[m_spilledCount].size;
+    size_t at = m_spillHead;
+    if (at + size > m_spillLimit) {
+      if (!m_circular || size > m_spillLimit)
+        return m_circular;
+      // Volta ao inicio: o que sobrou da volta anterior no fim do arquivo
+      // e o mais antigo e sai primeiro.
+      while (m_spilledCount > 0 && m_frames.front().offset >= m_spillHead)
+        if (!popFrontGop())
+          return true;
+      at = 0;
+      m_spillHead = 0;
+    }
+    if (m_circular && m_spilledCount > 0) {
+      const Encoded &front = m_frames.front();
+      if (front.offset < at + size && front.offset + front.size > at) {
+        if (!popFrontGop())
+          return true;
+        continue; // o registro a mover pode ter saido junto
+      }
+    }
+    if (!m_spill.reserve(at + size)) {
+      if (!m_circular)
+        return false;
+      // Sem mais disco: o anel fica do tamanho ja alocado.
+      m_spillLimit = m_spill.allocated();
+      if (m_spillLimit == 0)
+        return true;
+      continue;
+    }
+    Encoded &rec = m_frames[m_spilledCount];
+    std::memcpy(m_spill.data() + at, rec.data.data(), size);
+    rec.offset = at;
+    std::vector<std::uint8_t>().swap(rec.data);
+    m_used -= size;
+    m_spillLive += size;
+    m_spillHead = at + size;
+    ++m_spilledCount;
+  }
+  return true;
+}
+
+bool CompressedFrameStore::readFrame(size_t index, RawFrame &out) const {
+  std::lock_guard<std::mutex> reader(m_readMutex);
+  size_t id = 0;
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (index >= m_frames.size())
+      return false;
+    id = m_firstId + index;
+  }
+  return readAt(id, m_reader, out);
+}
+
+bool CompressedFrameStore::readAt(size_t id, Cursor &cursor,
+                                  RawFrame &out) const {
+  {
+    // Sob o lock so copia os registros comprimidos (poucos KB): exports em
+    // paralelo nao seguram o worker nem, pela fila cheia, a captura.
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (id < m_firstId || id - m_firstId >= m_frames.size())
+      return false;
+    const size_t index = id - m_firstId;
+    size_t key = index;
+    while (key > 0 && !m_frames[key].key)
+      --key;
+    // Continua do cursor quando ele esta no mesmo GOP, antes do alvo.
+    size_t start = key;
+    if (cursor.id != SIZE_MAX && cursor.id >= m_firstId + key &&
+        cursor.id <= id)
+      start = cursor.id - m_firstId + 1;
+    cursor.records.clear();
+    cursor.bytes.clear();
+    for (size_t j = start; j <= index; ++j) {
+      const Encoded &rec = m_frames[j];
+      Encoded copy;
+      copy.width = rec.width;
+      copy.height = rec.height;
+      copy.size = rec.size;
+      copy.key = rec.key;
+      copy.offset = cursor.bytes.size();
+      const std::uint8_t *bytes = bytesOf(rec);
+      cursor.bytes.insert(cursor.bytes.end(), bytes, bytes + rec.size);
+      cursor.records.push_back(std::move(copy));
+    }
+  }
+  for (const Encoded &rec : cursor.records)
+    decode(rec, cursor.bytes.data() + rec.offset, cursor.frame);
+  cursor.id = id;
+  out.resize(cursor.frame.width, cursor.frame.height);
+  std::memcpy(out.pixels.data(), cursor.frame.pixels.data(), out.bytes());
+  return true;
+}
+
+std::unique_ptr<CompressedFrameStore::Snapshot>
+CompressedFrameStore::snapshot(size_t maxTicks) {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  size_t first = 0;
+  if (maxTicks > 0) {
+    first = m_frames.size();
+    for (size_t ticks = 0; first > 0 && ticks < maxTicks;)
+      ticks += m_frames[--first].repeat;
+  }
+  // A decodificacao do primeiro frame precisa do keyframe antes dele.
+  size_t key = first;
+  while (key > 0 && !m_frames[key].key)
+    --key;
+  const size_t count = m_frames.size() - first;
+  const size_t lastRepeat = count > 0 ? m_frames.back().repeat : 0;
+  m_pins.insert(m_firstId + key);
+  return std::unique_ptr<Snapshot>(new Snapshot(
+      *this, m_firstId + first, count, lastRepeat, m_firstId + key,
+      m_generation));
+}
+
+CompressedFrameStore::Snapshot::~Snapshot() {
+  std::lock_guard<std::mutex> lk(m_store.m_mutex);
+  m_store.m_pins.erase(m_store.m_pins.find(m_pin));
+  // O que ficou retido alem do orcamento/janela sai agora.
+  if (m_store.m_spill.isOpen())
+    m_store.spillLocked();
+  else if (m_store.m_circular)
+    m_store.evictLocked();
+  m_store.trimWindowLocked();
+}
+
+bool CompressedFrameStore::Snapshot::readFrame(size_t index,
+                                               RawFrame &out) const {
+  if (index >= m_count)
+    return false;
+  return m_store.readAt(m_first + index, m_cursor, out);
+}
+
+size_t CompressedFrameStore::Snapshot::frameRepeat(size_t index) const {
+  if (index + 1 == m_count)
+    return m_lastRepeat;
+  std::lock_guard<std::mutex> lk(m_store.m_mutex);
+  const size_t at = m_first - m_store.m_firstId + index;
+  if (index >= m_count || m_first < m_store.m_firstId ||
+      at >= m_store.m_frames.size())
+    return 0;
+  return m_store.m_frames[at].repeat;
+}
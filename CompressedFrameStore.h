@@ -0,0 +1,186 @@
+#pragma once
+#include "FrameSource.h"
+#include "RawFrame.h"
+#include "SpillFile.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Frames em memoria comprimidos sem perda: cada frame e o XOR com o anterior
+// (keyframe a cada KEY_INTERVAL) codificado em RLE de pixels de 32 bits, o que
+// reduz frames de UI com cores chapadas a poucos KB. Frames identicos ao
+// anterior viram so um contador de repeticao. A codificacao roda numa
+// thread propria; a capacidade e um orcamento de bytes comprimidos.
+//
+// Com enableSpill(), o orcamento passa a ser so a janela quente em RAM: os
+// registros mais antigos vao, em ordem, para um arquivo temporario mapeado em
+// memoria (append-only; anel no modo circular) e sao decodificados direto do
+// mapeamento, sem copia intermediaria.
+class CompressedFrameStore : public FrameSource {
+public:
+    static constexpr size_t KEY_INTERVAL = 60;
+    static constexpr size_t QUEUE_DEPTH = 8;
+
+    explicit CompressedFrameStore(size_t budgetBytes = 256u << 20) : m_budget(budgetBytes) {}
+    ~CompressedFrameStore() override;
+
+    CompressedFrameStore(const CompressedFrameStore&) = delete;
+    CompressedFrameStore& operator=(const CompressedFrameStore&) = delete;
+
+    // Entrega o frame ao worker e devolve em `frame` um buffer reciclado
+    // (possivelmente vazio). Bloqueia se a fila estiver cheia. `repeat` > 1
+    // guarda o frame como varios ticks de captura seguidos.
+    void push(RawFrame& frame, size_t repeat = 1);
+    // Espera todos os frames enfileirados serem codificados.
+    void waitIdle() const;
+    // false (sem limpar) enquanto houver snapshot vivo: um export em
+    // andamento le esses registros e falharia no meio.
+    bool clear();
+
+    // Cheio: sem modo circular, novos frames sao descartados; com modo
+    // circular, os GOPs mais antigos sao removidos.
+    void setCircular(bool circular);
+    // Modo circular por tempo: remove GOPs antigos enquanto os restantes
+    // ainda cobrirem `ticks` ticks de captura (0 = so o orcamento manda).
+    void setWindow(size_t ticks);
+    void setBudget(size_t bytes);
+    size_t budget() const { return m_budget; }
+    // Liga o transbordo para disco com ate diskBytes de arquivo. Descarta os
+    // frames atuais. false se o arquivo nao pode ser criado ou se ha
+    // snapshot vivo (ver clear()).
+    bool enableSpill(size_t diskBytes);
+    bool spilling() const;
+    size_t spilledBytes() const;
+    size_t spillCapacity() const;
+    size_t usedBytes() const;
+    size_t rawBytes() const;     // tamanho equivalente sem compressao
+    size_t droppedFrames() const;
+    size_t captureCount() const; // frames unicos + repeticoes
+    bool full() const;
+
+    size_t frameCount() const override;
+    bool readFrame(size_t index, RawFrame& out) const override;
+    size_t frameRepeat(size_t index) const override;
+    size_t frameId(size_t index) const override;
+    // Nova a cada clear() (e enableSpill, que limpa).
+    std::uint64_t generation() const override;
+
+    class Snapshot;
+    // Faixa fixa com os frames guardados agora (so os que cobrem os ultimos
+    // maxTicks; 0 = todos), legivel enquanto a captura continua: ate o
+    // snapshot ser destruido, o modo circular nao remove essa faixa e o store
+    // pode passar do orcamento. Nada e copiado. Cada snapshot tem seu
+    // cursor de decodificacao: exports em paralelo nao disputam o mesmo GOP.
+    std::unique_ptr<Snapshot> snapshot(size_t maxTicks = 0);
+
+private:
+    static constexpr size_t NOT_SPILLED = SIZE_MAX;
+
+    struct Encoded {
+        std::vector<std::uint8_t> data;
+        unsigned width = 0;
+        unsigned height = 0;
+        size_t size = 0;            // bytes codificados
+        size_t offset = NOT_SPILLED; // posicao no arquivo de spill
+        size_t repeat = 1;
+        bool key = false;
+    };
+
+    static std::uint64_t newGeneration();
+    void workerLoop();
+    void encode(const RawFrame& frame, bool key, std::vector<std::uint8_t>& out) const;
+    static void decode(const Encoded& enc, const std::uint8_t* data, RawFrame& out);
+    const std::uint8_t* bytesOf(const Encoded& enc) const;
+    void append(Encoded enc);
+    void evictLocked();
+    void trimWindowLocked();
+    size_t frontGop(size_t& ticks) const;
+    bool popFrontGop();
+    // Ultimo frame decodificado por um leitor (id absoluto) e os registros
+    // que faltam ate o alvo, copiados sob o lock (so cabecalho e bytes
+    // comprimidos) e decodificados fora dele.
+    struct Cursor {
+        RawFrame frame;
+        size_t id = SIZE_MAX;
+        std::vector<Encoded> records; // offset = posicao em bytes
+        std::vector<std::uint8_t> bytes;
+    };
+    bool readAt(size_t id, Cursor& cursor, RawFrame& out) const;
+    bool spillLocked();
+
+    size_t m_budget;
+    bool m_circular = false;
+    size_t m_window = 0;
+
+    mutable std::mutex m_mutex;
+    mutable std::condition_variable m_cv;
+    std::thread m_worker;
+    bool m_stop = false;
+    bool m_busy = false;
+    bool m_forceKey = true;
+    std::deque<std::pair<RawFrame, size_t>> m_queue; // frame, repeticoes
+    std::vector<RawFrame> m_pool;
+
+    std::deque<Encoded> m_frames;
+    size_t m_firstId = 0;       // id absoluto de m_frames.front(); so cresce
+    std::uint64_t m_generation = newGeneration();
+    std::multiset<size_t> m_pins; // primeiro id protegido de cada snapshot
+    size_t m_used = 0;          // bytes em RAM
+    size_t m_raw = 0;
+    size_t m_captures = 0;
+    size_t m_dropped = 0;
+    bool m_full = false;
+
+    // Transbordo: os primeiros m_spilledCount registros estao no arquivo.
+    SpillFile m_spill;
+    size_t m_spillHead = 0;     // proxima posicao de escrita
+    size_t m_spilledCount = 0;
+    size_t m_spillLive = 0;     // bytes de registros vivos no arquivo
+    size_t m_spillLimit = 0;    // tamanho do anel (capacidade ou disco livre)
+
+    // Estado do worker (so ele toca).
+    RawFrame m_previous;
+    size_t m_sinceKey = 0;
+    std::vector<std::uint8_t> m_scratch;
+
+    // Cursor das leituras direto no store (snapshots tem o seu).
+    mutable std::mutex m_readMutex;
+    mutable Cursor m_reader;
+};
+
+class CompressedFrameStore::Snapshot : public FrameSource {
+public:
+    ~Snapshot() override;
+
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    size_t frameCount() const override { return m_count; }
+    // false fora da faixa (o store nao e limpo enquanto o snapshot vive).
+    bool readFrame(size_t index, RawFrame& out) const override;
+    size_t frameRepeat(size_t index) const override;
+    size_t frameId(size_t index) const override { return m_first + index; }
+    std::uint64_t generation() const override { return m_generation; }
+
+private:
+    friend class CompressedFrameStore;
+    Snapshot(CompressedFrameStore& store, size_t first, size_t count,
+             size_t lastRepeat, size_t pin, std::uint64_t generation)
+        : m_store(store), m_first(first), m_count(count),
+          m_lastRepeat(lastRepeat), m_pin(pin), m_generation(generation) {}
+
+    CompressedFrameStore& m_store;
+    size_t m_first;      // id absoluto do primeiro frame
+    size_t m_count;
+    size_t m_lastRepeat; // repeticoes do ultimo frame no momento do snapshot
+    size_t m_pin;
+    std::uint64_t m_generation;
+    mutable Cursor m_cursor; // um leitor por snapshot
+};
@@ -0,0 +1,140 @@
+#include "ExportScheduler.h"
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+namespace {
+std::chrono::steady_clock::rep nowTicks() {
+  return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+} // namespace
+
+double ExportJob::elapsed() const {
+  const auto started = m_started.load();
+  if (started == 0)
+    return 0.0;
+  const auto ended = m_ended.load();
+  const std::chrono::steady_clock::duration d((ended ? ended : nowTicks()) -
+                                              started);
+  return std::chrono::duration<double>(d).count();
+}
+
+ExportScheduler::ExportScheduler(size_t workers) {
+  for (size_t i = 0; i < std::max<size_t>(workers, 1); ++i)
+    m_threads.emplace_back(&ExportScheduler::loop, this);
+}
+
+ExportScheduler::~ExportScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+    for (const auto &job : m_jobs)
+      job->m_cancel.cancel();
+  }
+  m_cv.notify_all();
+  for (std::thread &t : m_threads)
+    t.join();
+}
+
+std::shared_ptr<const ExportJob>
+ExportScheduler::submit(ExportKind kind, std::string label,
+                        ExportJob::Work work, ExportJob::Done onDone,
+                        ExportPriority priority) {
+  std::shared_ptr<ExportJob> job;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    job.reset(new ExportJob(m_nextId++, kind, std::move(label), priority,
+                            std::move(work), std::move(onDone)));
+    m_queue.push_back(job);
+    m_jobs.push_back(job);
+  }
+  m_cv.notify_one();
+  return job;
+}
+
+void ExportScheduler::cancel(std::uint64_t id) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto &job : m_jobs)
+    if (job->id() == id)
+      job->m_cancel.cancel();
+}
+
+void ExportScheduler::cancelAll() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto &job : m_jobs)
+    job->m_cancel.cancel();
+}
+
+void ExportScheduler::poll() {
+  std::vector<std::shared_ptr<ExportJob>> done;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto split = std::stable_partition(
+        m_jobs.begin(), m_jobs.end(),
+        [](const std::shared_ptr<ExportJob> &job) { return !job->finished(); });
+    done.assign(split, m_jobs.end());
+    m_jobs.erase(split, m_jobs.end());
+  }
+  // Fora do lock: o callback pode enviar outro job.
+  for (const auto &job : done)
+    if (job->m_onDone)
+      job->m_onDone(*job);
+}
+
+std::vector<std::shared_ptr<const ExportJob>> ExportScheduler::jobs() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return {m_jobs.begin(), m_jobs.end()};
+}
+
+bool ExportScheduler::busy() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return !m_jobs.empty();
+}
+
+bool ExportScheduler::active(ExportKind kind) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return std::any_of(
+      m_jobs.begin(), m_jobs.end(),
+      [kind](const std::shared_ptr<ExportJob> &job) { return job->kind() == kind; });
+}
+
+void ExportScheduler::loop() {
+  for (;;) {
+    std::shared_ptr<ExportJob> job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+      if (m_stop)
+        return;
+      // Maior prioridade; empate fica com o mais antigo (menor id).
+      auto next = std::max_element(
+          m_queue.begin(), m_queue.end(),
+          [](const std::shared_ptr<ExportJob> &a,
+             const std::shared_ptr<ExportJob> &b) {
+            if (a->priority() != b->priority())
+              return a->priority() < b->priority();
+            return a->id() > b->id();
+          });
+      job = *next;
+      m_queue.erase(next);
+    }
+
+    if (job->cancelled()) {
+      job->m_state = ExportState::Cancelled;
+      continue;
+    }
+    job->m_started = nowTicks();
+    job->m_state = ExportState::Running;
+    bool ok = false;
+    try {
+      ok = job->m_work(*job);
+    } catch (const std::exception &e) {
+      std::cerr << "[ExportScheduler] " << job->label() << ": " << e.what()
+                << '\n';
+    }
+    job->m_ended = nowTicks();
+    job->m_state = job->cancelled() ? ExportState::Cancelled
+                   : ok             ? ExportState::Done
+                                    : ExportState::Failed;
+  }
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class ExportKind { Frames, Video, Animation, Replay };
+enum class ExportPriority { Low, Normal, High };
+enum class ExportState { Queued, Running, Done, Failed, Cancelled };
+
+// Progresso de um job: escrito pela thread do job, lido pela UI a cada frame
+// sem lock. Campos que o export nao conhece ficam em 0.
+struct ExportProgress {
+    std::atomic<size_t> current{0};
+    std::atomic<size_t> total{0};
+    std::atomic<size_t> bytes{0};   // saida gerada ate agora
+    std::atomic<double> fps{0.0};   // frames processados por segundo
+    std::atomic<double> speed{0.0}; // segundos de video por segundo (1.0 = tempo real)
+    std::atomic<double> throughput{0.0}; // bytes gravados em disco por segundo
+    std::atomic<size_t> queueDepth{0};   // buffers esperando a escrita
+
+    void set(size_t cur, size_t tot) {
+        total = tot;
+        current = cur;
+    }
+    double fraction() const {
+        const size_t tot = total;
+        return tot > 0 ? static_cast<double>(current) / tot : 0.0;
+    }
+};
+
+// Pedido de cancelamento compartilhado entre quem pede e o job. Copias
+// apontam para a mesma flag; serve direto como shouldCancel dos exports.
+class CancelToken {
+public:
+    CancelToken() : m_flag(std::make_shared<std::atomic<bool>>(false)) {}
+    void cancel() const { *m_flag = true; }
+    bool cancelled() const { return *m_flag; }
+    bool operator()() const { return cancelled(); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> m_flag;
+};
+
+class ExportJob {
+public:
+    // Roda numa thread do scheduler; true = sucesso.
+    using Work = std::function<bool(ExportJob&)>;
+    // Roda na thread que chama ExportScheduler::poll() (a da UI).
+    using Done = std::function<void(const ExportJob&)>;
+
+    std::uint64_t id() const { return m_id; }
+    ExportKind kind() const { return m_kind; }
+    const std::string& label() const { return m_label; }
+    ExportPriority priority() const { return m_priority; }
+    ExportState state() const { return m_state; }
+    bool finished() const { return state() > ExportState::Running; }
+
+    ExportProgress& progress() { return m_progress; }
+    const ExportProgress& progress() const { return m_progress; }
+    const CancelToken& cancelToken() const { return m_cancel; }
+    bool cancelled() const { return m_cancel.cancelled(); }
+    // Segundos rodando (0 enquanto na fila).
+    double elapsed() const;
+
+private:
+    friend class ExportScheduler;
+    ExportJob(std::uint64_t id, ExportKind kind, std::string label, ExportPriority priority,
+              Work work, Done onDone)
+        : m_id(id), m_kind(kind), m_label(std::move(label)), m_priority(priority),
+          m_work(std::move(work)), m_onDone(std::move(onDone)) {}
+
+    std::uint64_t m_id;
+    ExportKind m_kind;
+    std::string m_label;
+    ExportPriority m_priority;
+    Work m_work;
+    Done m_onDone;
+    ExportProgress m_progress;
+    CancelToken m_cancel;
+    std::atomic<ExportState> m_state{ExportState::Queued};
+    std::atomic<std::chrono::steady_clock::rep> m_started{0};
+    std::atomic<std::chrono::steady_clock::rep> m_ended{0};
+};
+
+// Fila de exports com threads proprias: maior prioridade primeiro, FIFO
+// dentro da mesma prioridade. Varios jobs rodam ao mesmo tempo sem travar
+// o loop de frames; o termino e entregue por poll() na thread da UI.
+class ExportScheduler {
+public:
+    explicit ExportScheduler(size_t workers = 3);
+    // Cancela tudo e espera os jobs em execucao; onDone nao e mais chamado.
+    ~ExportScheduler();
+
+    ExportScheduler(const ExportScheduler&) = delete;
+    ExportScheduler& operator=(const ExportScheduler&) = delete;
+
+    std::shared_ptr<const ExportJob> submit(ExportKind kind, std::string label,
+                                            ExportJob::Work work,
+                                            ExportJob::Done onDone = nullptr,
+                                            ExportPriority priority = ExportPriority::Normal);
+    // Na fila, o job termina como Cancelled sem rodar; rodando, o export
+    // ve o token e para no proximo frame.
+    void cancel(std::uint64_t id);
+    void cancelAll();
+
+    // Uma vez por frame na thread da UI: chama onDone dos jobs terminados e
+    // os tira da lista.
+    void poll();
+
+    // Jobs ainda nao entregues por poll(), em ordem de envio.
+    std::vector<std::shared_ptr<const ExportJob>> jobs() const;
+    bool busy() const;
+    bool active(ExportKind kind) const;
+
+private:
+    void loop();
+
+    std::vector<std::thread> m_threads;
+    std::vector<std::shared_ptr<ExportJob>> m_queue;
+    std::vector<std::shared_ptr<ExportJob>> m_jobs;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::uint64_t m_nextId = 1;
+    bool m_stop = false;
+};
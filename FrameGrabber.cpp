@@ -0,0 +1,136 @@
+#include "FrameGrabber.h"
+#include <iostream>
+
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ 0x88E1
+#endif
+#ifndef GL_READ_ONLY
+#define GL_READ_ONLY 0x88B8
+#endif
+
+FrameGrabber::~FrameGrabber() {
+  if (m_pbo[0] || m_pbo[1]) {
+    // Contextos SFML compartilham objetos; qualquer um ativo serve.
+    sf::Context context;
+    releaseBuffers();
+  }
+}
+
+bool FrameGrabber::loadFunctions() {
+  if (!sf::Context::isExtensionAvailable("GL_ARB_pixel_buffer_object") &&
+      !sf::Context::isExtensionAvailable("GL_EXT_pixel_buffer_object"))
+    return false;
+  m_genBuffers =
+      reinterpret_cast<GenBuffersFn>(sf::Context::getFunction("glGenBuffers"));
+  m_deleteBuffers = reinterpret_cast<DeleteBuffersFn>(
+      sf::Context::getFunction("glDeleteBuffers"));
+  m_bindBuffer =
+      reinterpret_cast<BindBufferFn>(sf::Context::getFunction("glBindBuffer"));
+  m_bufferData =
+      reinterpret_cast<BufferDataFn>(sf::Context::getFunction("glBufferData"));
+  m_mapBuffer =
+      reinterpret_cast<MapBufferFn>(sf::Context::getFunction("glMapBuffer"));
+  m_unmapBuffer = reinterpret_cast<UnmapBufferFn>(
+      sf::Context::getFunction("glUnmapBuffer"));
+  return m_genBuffers && m_deleteBuffers && m_bindBuffer && m_bufferData &&
+         m_mapBuffer && m_unmapBuffer;
+}
+
+void FrameGrabber::releaseBuffers() {
+  if (m_deleteBuffers && (m_pbo[0] || m_pbo[1]))
+    m_deleteBuffers(2, m_pbo);
+  m_pbo[0] = m_pbo[1] = 0;
+  m_pending = false;
+}
+
+void FrameGrabber::prepare(unsigned width, unsigned height) {
+  if (!m_probed) {
+    m_probed = true;
+    m_usePbo = loadFunctions();
+    std::cout << "[FrameGrabber] Leitura "
+              << (m_usePbo ? "assincrona via PBO" : "sincrona (sem PBO)")
+              << '\n';
+  }
+  if (width == m_width && height == m_height && (!m_usePbo || m_pbo[0]))
+    return;
+  m_width = width;
+  m_height = height;
+  if (!m_usePbo) {
+    m_sync.resize(static_cast<size_t>(width) * height * 4);
+    return;
+  }
+  releaseBuffers();
+  const auto bytes = static_cast<std::ptrdiff_t>(width) * height * 4;
+  m_genBuffers(2, m_pbo);
+  for (GLuint pbo : m_pbo) {
+    m_bindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+    m_bufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+  }
+  m_bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  m_index = 0;
+}
+
+FrameView FrameGrabber::viewOf(const std::uint8_t *pixels) const {
+  FrameView view;
+  view.pixels = pixels;
+  view.width = m_width;
+  view.height = m_height;
+  view.stride = static_cast<size_t>(m_width) * 4;
+  view.bottomUp = true;
+  return view;
+}
+
+bool FrameGrabber::readPending(const Consumer &consume) {
+  if (!m_pending)
+    return false;
+  m_pending = false;
+  m_bindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo[m_index ^ 1]);
+  const void *mapped = m_mapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+  if (mapped)
+    consume(viewOf(static_cast<const std::uint8_t *>(mapped)));
+  m_unmapBuffer(GL_PIXEL_PACK_BUFFER);
+  m_bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  return mapped != nullptr;
+}
+
+bool FrameGrabber::grab(sf::RenderTarget &target, const Consumer &consume) {
+  const sf::Vector2u size = target.getSize();
+  if (size.x == 0 || size.y == 0 || !target.setActive(true))
+    return false;
+  // O frame em voo tem o tamanho antigo: sai antes de prepare() refazer os
+  // PBOs. Os sinks ja contaram com ele em requested(); descartado, o tempo
+  // de cada captura seguinte ficaria com um frame de atraso.
+  bool delivered = false;
+  if (size.x != m_width || size.y != m_height)
+    delivered = readPending(consume);
+  prepare(size.x, size.y);
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+  if (!m_usePbo) {
+    glReadPixels(0, 0, static_cast<GLsizei>(m_width),
+                 static_cast<GLsizei>(m_height), GL_RGBA, GL_UNSIGNED_BYTE,
+                 m_sync.data());
+    consume(viewOf(m_sync.data()));
+    return true;
+  }
+
+  m_bindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo[m_index]);
+  glReadPixels(0, 0, static_cast<GLsizei>(m_width),
+               static_cast<GLsizei>(m_height), GL_RGBA, GL_UNSIGNED_BYTE,
+               nullptr);
+  m_bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  // Enquanto a copia atual corre, mapeia a do frame anterior.
+  const bool ready = readPending(consume);
+  m_index ^= 1;
+  m_pending = true;
+  return ready || delivered;
+}
+
+bool FrameGrabber::flush(sf::RenderTarget &target, const Consumer &consume) {
+  if (!m_pending || !m_usePbo || !target.setActive(true))
+    return false;
+  return readPending(consume);
+}
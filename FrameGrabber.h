@@ -0,0 +1,65 @@
+#pragma once
+#include "RawFrame.h"
+#include <SFML/Graphics.hpp>
+#include <SFML/OpenGL.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Leitura de pixels de um RenderTarget sem alocar em regime permanente.
+// Com pixel buffer objects (GL 2.1 / ARB_pixel_buffer_object) a leitura e
+// assincrona em buffer duplo: grab() dispara a copia do frame atual e entrega
+// o frame anterior, evitando o stall GPU->CPU. Sem PBO cai para glReadPixels
+// sincrono num buffer interno. O consumidor recebe uma FrameView do buffer
+// (mapeado), sem copia do frame inteiro, e copia so o que precisa.
+class FrameGrabber {
+public:
+    FrameGrabber() = default;
+    ~FrameGrabber();
+
+    FrameGrabber(const FrameGrabber&) = delete;
+    FrameGrabber& operator=(const FrameGrabber&) = delete;
+
+    using Consumer = std::function<void(const FrameView&)>;
+
+    // Le o conteudo atual de target (antes do display() da janela). Retorna
+    // true se consume foi chamado; no modo PBO com o frame anterior, que
+    // tambem sai (no tamanho antigo) quando o target muda de tamanho.
+    bool grab(sf::RenderTarget& target, const Consumer& consume);
+    // Entrega o frame ainda em voo (modo PBO), sem disparar nova leitura.
+    bool flush(sf::RenderTarget& target, const Consumer& consume);
+
+    bool pending() const { return m_pending; }
+    bool asynchronous() const { return m_usePbo; }
+
+private:
+    using GenBuffersFn = void(APIENTRY*)(GLsizei, GLuint*);
+    using DeleteBuffersFn = void(APIENTRY*)(GLsizei, const GLuint*);
+    using BindBufferFn = void(APIENTRY*)(GLenum, GLuint);
+    using BufferDataFn = void(APIENTRY*)(GLenum, std::ptrdiff_t, const void*, GLenum);
+    using MapBufferFn = void*(APIENTRY*)(GLenum, GLenum);
+    using UnmapBufferFn = GLboolean(APIENTRY*)(GLenum);
+
+    bool loadFunctions();
+    void prepare(unsigned width, unsigned height);
+    void releaseBuffers();
+    bool readPending(const Consumer& consume);
+    FrameView viewOf(const std::uint8_t* pixels) const;
+
+    bool m_probed = false;
+    bool m_usePbo = false;
+    GenBuffersFn m_genBuffers = nullptr;
+    DeleteBuffersFn m_deleteBuffers = nullptr;
+    BindBufferFn m_bindBuffer = nullptr;
+    BufferDataFn m_bufferData = nullptr;
+    MapBufferFn m_mapBuffer = nullptr;
+    UnmapBufferFn m_unmapBuffer = nullptr;
+
+    GLuint m_pbo[2] = {0, 0};
+    unsigned m_index = 0;        // PBO que recebe a proxima leitura
+    bool m_pending = false;      // leitura em voo em m_pbo[m_index ^ 1]
+    unsigned m_width = 0;
+    unsigned m_height = 0;
+    std::vector<std::uint8_t> m_sync; // destino do glReadPixels sem PBO
+};
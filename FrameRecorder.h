@@ -1,66 +1,189 @@
 #pragma once
+#include "CompressedFrameStore.h"
+#include "FrameScaler.h"
+#include "FrameSink.h"
 #include "PersistenceDAO.h"
+#include "RawFrame.h"
 #include <SFML/Graphics.hpp>
+#include <cmath>
+#include <deque>
+#include <memory>
 #include <string>
-#include <vector>
 
-class FrameRecorder {
+class FrameRecorder : public FrameSink {
 public:
-  explicit FrameRecorder(size_t maxFrames = 900) : m_maxFrames(maxFrames) {}
-  void enable(bool on) { m_enabled = on; }
+  static constexpr size_t DEFAULT_BUDGET = 256u << 20;
+
+  explicit FrameRecorder(size_t budgetBytes = DEFAULT_BUDGET)
+      : m_store(budgetBytes) {}
+  void enable(bool on) {
+    if (on && !m_enabled)
+      restartSchedule();
+    m_enabled = on;
+  }
   bool enabled() const { return m_enabled; }
-  size_t count() const { return m_frames.size(); }
-  void clearMemory() { m_frames.clear(); }
-  void setCircular(bool circular) { m_circular = circular; }
+  // Com taxa definida, so captura quando o relogio da simulacao passa do
+  // proximo tick; frames que cobrem varios ticks (render mais lento que a
+  // captura) sao guardados com repeticao, entao a duracao no video bate com
+  // o tempo simulado.
+  bool capturing() const override { return m_enabled && dueTicks() > 0; }
+  void requested() override {
+    const size_t due = dueTicks();
+    m_requested.push_back(due);
+    m_emitted += due;
+  }
+  // Avanca o relogio da simulacao (chamado pelo update do visualizador).
+  void advance(double seconds) {
+    if (m_enabled)
+      m_clock += seconds;
+  }
+  // Ticks de captura por segundo simulado; 0 = um por frame desenhado.
+  void setCaptureRate(double fps) {
+    m_rate = fps > 0.0 ? fps : 0.0;
+    restartSchedule();
+    m_store.setWindow(replayTicks(m_replaySeconds));
+  }
+  double captureRate() const { return m_rate; }
+  // Fator (0, 1] aplicado no momento da captura; reduz memoria e exportacao.
+  void setOutputScale(float scale) {
+    m_scale = scale > 0.f && scale < 1.f ? scale : 1.f;
+  }
+  float outputScale() const { return m_scale; }
+  size_t count() const { return m_store.frameCount(); }
+  // Inclui frames repetidos, que ocupam so um contador.
+  size_t captureCount() const { return m_store.captureCount(); }
+  // false enquanto um export le um snapshot destes frames.
+  bool clearMemory() { return m_store.clear(); }
+  void setCircular(bool circular) {
+    m_circular = circular;
+    m_store.setCircular(circular);
+  }
   bool isCircular() const { return m_circular; }
-  void setMaxFrames(size_t newMax) {
-    if (newMax == 0)
-      return;
-    if (newMax < m_frames.size()) {
-      m_frames.resize(newMax);
+  // Instant replay: no modo circular guarda os ultimos `seconds` segundos de
+  // captura (sem taxa definida, conta 60 frames desenhados por segundo).
+  void setReplayWindow(double seconds) {
+    m_replaySeconds = seconds > 0.0 ? seconds : 0.0;
+    m_store.setWindow(replayTicks(m_replaySeconds));
+  }
+  double replayWindow() const { return m_replaySeconds; }
+  // Faixa dos ultimos `seconds` (0 = tudo) que pode ser exportada em outra
+  // thread enquanto a captura continua, sem copiar o anel.
+  std::unique_ptr<CompressedFrameStore::Snapshot> snapshot(double seconds = 0.0) {
+    m_store.waitIdle();
+    return m_store.snapshot(replayTicks(seconds));
+  }
+  // Capacidade em bytes comprimidos, nao em frames.
+  void setMemoryBudget(size_t bytes) {
+    if (bytes > 0)
+      m_store.setBudget(bytes);
+  }
+  size_t memoryBudget() const { return m_store.budget(); }
+  size_t memoryUsed() const { return m_store.usedBytes(); }
+  size_t rawBytes() const { return m_store.rawBytes(); }
+  // Com spill, o orcamento acima vira a janela em RAM e o resto vai para um
+  // arquivo temporario de ate diskBytes. Descarta os frames ja capturados.
+  bool enableSpill(size_t diskBytes) { return m_store.enableSpill(diskBytes); }
+  size_t spilledBytes() const { return m_store.spilledBytes(); }
+  bool full() const { return m_store.full(); }
+  void setFrameFormat(const FrameWriterOptions &options) {
+    m_persistence.setFrameFormat(options);
+  }
+  const FrameWriterOptions &frameFormat() const {
+    return m_persistence.frameFormat();
+  }
+  // Chamado pelo CaptureService com o frame lido uma vez por janela: copia
+  // (ou reduz) so a regiao inscrita para um buffer reciclado pelo store, que
+  // comprime numa thread propria.
+  void accept(const FrameView &view, const sf::IntRect &region) override {
+    size_t repeat = 1;
+    if (!m_requested.empty()) {
+      repeat = m_requested.front();
+      m_requested.pop_front();
     }
-    m_maxFrames = newMax;
-    if (m_overwriteIndex >= m_maxFrames) {
-      m_overwriteIndex = 0;
+    const FrameView sub =
+        subView(view, region.left, region.top, region.width, region.height);
+    if (m_scale < 1.f) {
+      unsigned w = 0, h = 0;
+      FrameScaler::outputSize(sub.width, sub.height, m_scale, w, h);
+      m_scaler.scale(sub, w, h, m_staging);
+    } else {
+      copyRegion(sub, 0, 0, 0, 0, m_staging);
     }
+    m_store.push(m_staging, repeat);
   }
-  size_t maxFrames() const { return m_maxFrames; }
-  void capture(const sf::RenderWindow &window) {
-    if (!m_enabled)
-      return;
-    sf::Texture t;
-    t.create(window.getSize().x, window.getSize().y);
-    t.update(window);
-    sf::Image img = t.copyToImage();
-    if (m_frames.size() < m_maxFrames) {
-      m_frames.push_back(std::move(img));
-    } else if (m_circular) {
-      m_frames[m_overwriteIndex] = std::move(img);
-      m_overwriteIndex = (m_overwriteIndex + 1) % m_maxFrames;
-    }
+  const FrameSource &frames() const {
+    m_store.waitIdle();
+    return m_store;
   }
   bool save(const std::string &dir, const std::string &prefix = "frame",
             const std::function<void(size_t, size_t)> &onProgress = nullptr,
-            const std::function<bool()> &shouldCancel = nullptr) {
+            const std::function<bool()> &shouldCancel = nullptr,
+            const WriteStatsFn &onWriteStats = nullptr) {
 
-    return m_persistence.saveFrames(m_frames, dir, prefix, 0, onProgress,
-                                    shouldCancel);
+    return save(frames(), dir, prefix, onProgress, shouldCancel, onWriteStats);
+  }
+  // Exports em outra thread recebem um snapshot(): com a captura rodando, o
+  // modo circular descarta frames da frente e os indices do store andam.
+  bool save(const FrameSource &frames, const std::string &dir,
+            const std::string &prefix = "frame",
+            const std::function<void(size_t, size_t)> &onProgress = nullptr,
+            const std::function<bool()> &shouldCancel = nullptr,
+            const WriteStatsFn &onWriteStats = nullptr) const {
+    return m_persistence.saveFrames(frames, dir, prefix, 0, onProgress,
+                                    shouldCancel, onWriteStats);
+  }
+  // Frames direto no stdin do ffmpeg (rawvideo), sem PNG. Com taxa de
+  // captura definida, ela manda no fps do video.
+  bool exportVideo(const FrameSource &frames, const std::string &file,
+                   int fps = 30,
+                   const VideoProgressFn &onProgress = nullptr,
+                   const std::function<bool()> &shouldCancel = nullptr) const {
+    return PersistenceDAO().exportRawVideo(frames, file, videoFps(fps),
+                                           onProgress, shouldCancel);
   }
-  bool exportVideo(const std::string &dir, const std::string &file,
-                   int fps = 30, const std::string &prefix = "frame") {
-    if (!save(dir, prefix))
-      return false;
-    return m_persistence.exportMP4(dir, file, fps);
+  // GIF/APNG/WebP (pelo sufixo) montado dos frames, sem ffmpeg.
+  bool exportAnimation(const FrameSource &frames, const std::string &file,
+                       int fps = 30,
+                       const std::function<void(size_t, size_t)> &onProgress = nullptr,
+                       const std::function<bool()> &shouldCancel = nullptr) const {
+    return m_persistence.exportAnimation(frames, file, videoFps(fps),
+                                         onProgress, shouldCancel);
   }
   bool clearSaved(const std::string &dir, const std::string &prefix = "frame") {
     return m_persistence.clearTempFiles(dir, prefix);
   }
 
 private:
-  size_t m_maxFrames;
+  int videoFps(int fallback) const {
+    return m_rate > 0.0 ? static_cast<int>(std::lround(m_rate)) : fallback;
+  }
+  size_t replayTicks(double seconds) const {
+    return static_cast<size_t>(std::ceil(seconds * (m_rate > 0.0 ? m_rate : 60.0)));
+  }
+  // Ticks vencidos ainda nao pedidos; o tick 0 cai em t = 0.
+  size_t dueTicks() const {
+    if (m_rate <= 0.0)
+      return 1;
+    const size_t ticks =
+        static_cast<size_t>(std::floor(m_clock * m_rate + 1e-6)) + 1;
+    return ticks > m_emitted ? ticks - m_emitted : 0;
+  }
+  void restartSchedule() {
+    m_clock = 0.0;
+    m_emitted = 0;
+    m_requested.clear();
+  }
+
   bool m_enabled = false;
   bool m_circular = false;
-  size_t m_overwriteIndex = 0;
-  std::vector<sf::Image> m_frames;
+  double m_rate = 0.0;
+  double m_replaySeconds = 0.0;
+  float m_scale = 1.f;
+  double m_clock = 0.0;
+  size_t m_emitted = 0;
+  std::deque<size_t> m_requested; // repeticoes de cada leitura em voo
+  CompressedFrameStore m_store;
+  FrameScaler m_scaler;
+  RawFrame m_staging;
   PersistenceDAO m_persistence;
 };
@@ -0,0 +1,162 @@
+#include "FrameScaler.h"
+#include <algorithm>
+#include <cmath>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+// acc[i] += src[i] para n bytes.
+void accumulateRow(std::uint16_t *acc, const std::uint8_t *src, size_t n) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= n; i += 16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    __m128i *a = reinterpret_cast<__m128i *>(acc + i);
+    _mm_storeu_si128(a, _mm_add_epi16(_mm_loadu_si128(a),
+                                      _mm_unpacklo_epi8(v, zero)));
+    _mm_storeu_si128(a + 1, _mm_add_epi16(_mm_loadu_si128(a + 1),
+                                          _mm_unpackhi_epi8(v, zero)));
+  }
+#endif
+  for (; i < n; ++i)
+    acc[i] = static_cast<std::uint16_t>(acc[i] + src[i]);
+}
+
+// out = (a * (256 - f) + b * f + 128) >> 8 para n bytes, f em [0, 256].
+void blendRows(std::uint8_t *out, const std::uint8_t *a, const std::uint8_t *b,
+               unsigned f, size_t n) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  // Produtos cabem em 16 bits sem sinal (<= 255 * 256), entao mullo/add
+  // modulares dao o valor exato.
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i wa = _mm_set1_epi16(static_cast<short>(256 - f));
+  const __m128i wb = _mm_set1_epi16(static_cast<short>(f));
+  const __m128i half = _mm_set1_epi16(128);
+  for (; i + 16 <= n; i += 16) {
+    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+    __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), wa),
+                               _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), wb));
+    __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), wa),
+                               _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), wb));
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, half), 8);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, half), 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                     _mm_packus_epi16(lo, hi));
+  }
+#endif
+  for (; i < n; ++i)
+    out[i] = static_cast<std::uint8_t>((a[i] * (256 - f) + b[i] * f + 128) >> 8);
+}
+
+FrameView viewOf(const RawFrame &frame) {
+  FrameView v;
+  v.pixels = frame.pixels.data();
+  v.width = frame.width;
+  v.height = frame.height;
+  v.stride = static_cast<size_t>(frame.width) * 4;
+  return v;
+}
+} // namespace
+
+void FrameScaler::outputSize(unsigned width, unsigned height, float scale,
+                             unsigned &outW, unsigned &outH) {
+  if (scale >= 1.f || scale <= 0.f) {
+    outW = width;
+    outH = height;
+    return;
+  }
+  auto scaled = [scale](unsigned v) {
+    const unsigned s = static_cast<unsigned>(std::lround(v * scale)) & ~1u;
+    return std::min(v, std::max(2u, s));
+  };
+  outW = scaled(width);
+  outH = scaled(height);
+}
+
+void FrameScaler::scale(const FrameView &view, unsigned outW, unsigned outH,
+                        RawFrame &out) {
+  if (view.width == 0 || view.height == 0 || outW == 0 || outH == 0) {
+    out.resize(0, 0);
+    return;
+  }
+  if (outW >= view.width && outH >= view.height) {
+    copyRegion(view, 0, 0, 0, 0, out);
+    return;
+  }
+  const unsigned k = std::min({view.width / outW, view.height / outH, MAX_BOX});
+  if (k < 2) {
+    bilinear(view, outW, outH, out);
+    return;
+  }
+  // Box primeiro: cada pixel de origem entra uma vez, sem aliasing.
+  if (view.width / k == outW && view.height / k == outH) {
+    box(view, k, out);
+    return;
+  }
+  box(view, k, m_box);
+  bilinear(viewOf(m_box), outW, outH, out);
+}
+
+void FrameScaler::box(const FrameView &view, unsigned k, RawFrame &out) {
+  // Sobras de menos de k colunas/linhas na borda sao ignoradas.
+  out.resize(view.width / k, view.height / k);
+  const size_t span = static_cast<size_t>(out.width) * k * 4;
+  m_acc.resize(span);
+  const std::uint64_t area = static_cast<std::uint64_t>(k) * k;
+  // (sum + area/2) / area como multiplicacao: sum < 2^17, erro < 2^-15.
+  const std::uint64_t recip = ((std::uint64_t(1) << 32) + area - 1) / area;
+  for (unsigned oy = 0; oy < out.height; ++oy) {
+    std::fill(m_acc.begin(), m_acc.end(), 0);
+    for (unsigned r = 0; r < k; ++r)
+      accumulateRow(m_acc.data(), view.row(oy * k + r), span);
+    std::uint8_t *dst = out.pixels.data() + static_cast<size_t>(oy) * out.width * 4;
+    const std::uint16_t *acc = m_acc.data();
+    for (unsigned ox = 0; ox < out.width; ++ox, acc += k * 4) {
+      std::uint32_t sum[4] = {0, 0, 0, 0};
+      for (unsigned j = 0; j < k; ++j)
+        for (unsigned c = 0; c < 4; ++c)
+          sum[c] += acc[j * 4 + c];
+      for (unsigned c = 0; c < 4; ++c)
+        *dst++ = static_cast<std::uint8_t>(((sum[c] + area / 2) * recip) >> 32);
+    }
+  }
+}
+
+void FrameScaler::bilinear(const FrameView &view, unsigned outW, unsigned outH,
+                           RawFrame &out) {
+  out.resize(outW, outH);
+  // Amostra no centro de cada pixel de saida; posicao em ponto fixo 24.8.
+  auto position = [](unsigned o, unsigned src, unsigned dst) {
+    const double s = (o + 0.5) * src / dst - 0.5;
+    const double clamped = std::min(std::max(s, 0.0), src - 1.0);
+    return static_cast<std::uint32_t>(clamped * 256.0 + 0.5);
+  };
+  m_xs.resize(outW);
+  for (unsigned ox = 0; ox < outW; ++ox)
+    m_xs[ox] = position(ox, view.width, outW);
+
+  const size_t rowBytes = static_cast<size_t>(view.width) * 4;
+  m_row.resize(rowBytes);
+  for (unsigned oy = 0; oy < outH; ++oy) {
+    const std::uint32_t py = position(oy, view.height, outH);
+    const unsigned y0 = py >> 8;
+    const unsigned fy = py & 0xFF;
+    const unsigned y1 = std::min(y0 + 1, view.height - 1);
+    // Vertical na linha inteira (SIMD), horizontal so nas colunas usadas.
+    blendRows(m_row.data(), view.row(y0), view.row(y1), fy, rowBytes);
+    std::uint8_t *dst = out.pixels.data() + static_cast<size_t>(oy) * outW * 4;
+    for (unsigned ox = 0; ox < outW; ++ox) {
+      const unsigned x0 = m_xs[ox] >> 8;
+      const unsigned fx = m_xs[ox] & 0xFF;
+      const unsigned x1 = std::min(x0 + 1, view.width - 1);
+      const std::uint8_t *a = m_row.data() + static_cast<size_t>(x0) * 4;
+      const std::uint8_t *b = m_row.data() + static_cast<size_t>(x1) * 4;
+      for (unsigned c = 0; c < 4; ++c)
+        *dst++ = static_cast<std::uint8_t>((a[c] * (256 - fx) + b[c] * fx + 128) >> 8);
+    }
+  }
+}
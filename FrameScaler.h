@@ -0,0 +1,31 @@
+#pragma once
+#include "RawFrame.h"
+#include <cstdint>
+#include <vector>
+
+// Reducao de frames RGBA no momento da captura. Fatores inteiros viram media
+// de blocos k x k (box); o resto do caminho ate o tamanho final e bilinear.
+// Os lacos quentes usam SSE2 quando disponivel. Guarda os buffers entre
+// chamadas para nao alocar a cada frame.
+class FrameScaler {
+public:
+    // Tamanho de saida para uma escala (0, 1]: arredondado para par, que o
+    // yuv420p do encoder exige.
+    static void outputSize(unsigned width, unsigned height, float scale,
+                           unsigned& outW, unsigned& outH);
+
+    // Reduz `view` para outW x outH em out (linha 0 no topo). Tamanho igual
+    // ou maior que a origem so copia.
+    void scale(const FrameView& view, unsigned outW, unsigned outH, RawFrame& out);
+
+private:
+    static constexpr unsigned MAX_BOX = 16;
+
+    void box(const FrameView& view, unsigned k, RawFrame& out);
+    void bilinear(const FrameView& view, unsigned outW, unsigned outH, RawFrame& out);
+
+    RawFrame m_box;
+    std::vector<std::uint16_t> m_acc;
+    std::vector<std::uint8_t> m_row;
+    std::vector<std::uint32_t> m_xs;
+};
@@ -0,0 +1,16 @@
+#pragma once
+#include "RawFrame.h"
+#include <SFML/Graphics.hpp>
+
+// Consumidor de frames do CaptureService: recebe a view do frame lido e a
+// regiao em que se inscreveu, e copia o que precisar antes de retornar.
+class FrameSink {
+public:
+    virtual ~FrameSink() = default;
+    virtual bool capturing() const = 0;
+    // Uma leitura foi disparada para este sink; o accept() correspondente
+    // chega na mesma chamada (leitura sincrona) ou na seguinte (PBO), na
+    // mesma ordem dos requested().
+    virtual void requested() {}
+    virtual void accept(const FrameView& view, const sf::IntRect& region) = 0;
+};
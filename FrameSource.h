@@ -0,0 +1,23 @@
+#pragma once
+#include "RawFrame.h"
+#include <cstddef>
+#include <cstdint>
+
+// Sequencia de frames lida por indice (0 = mais antigo). Leituras em ordem
+// crescente devem ser baratas; acesso aleatorio pode custar mais.
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+    virtual size_t frameCount() const = 0;
+    virtual bool readFrame(size_t index, RawFrame& out) const = 0;
+    // Quantas capturas consecutivas o frame representa (frames repetidos
+    // sao guardados uma vez so).
+    virtual size_t frameRepeat(size_t) const { return 1; }
+    // Identificador do frame que nao muda quando frames mais antigos saem da
+    // fonte (ids consecutivos e crescentes); permite exportar so o que e novo.
+    virtual size_t frameId(size_t index) const { return index; }
+    // Sessao a que os ids pertencem: muda quando a fonte recomeca (ids de
+    // sessoes diferentes nao se comparam) e nunca se repete entre processos.
+    // 0 = desconhecida; exports incrementais nao retomam dessa fonte.
+    virtual std::uint64_t generation() const { return 0; }
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <SFML/System.hpp>
+#include <algorithm>
+#include <cstddef>
+
+// Acumula o tempo gasto por frame e publica media/maximo a cada janela.
+class FrameStats {
+public:
+    explicit FrameStats(float windowSeconds = 1.f) : m_window(windowSeconds) {}
+
+    void begin() { m_frameClock.restart(); }
+    // Retorna true quando uma nova janela de medicao foi fechada.
+    bool end() {
+        float ms = m_frameClock.getElapsedTime().asMicroseconds() / 1000.f;
+        m_sum += ms;
+        m_peak = std::max(m_peak, ms);
+        ++m_count;
+        if (m_windowClock.getElapsedTime().asSeconds() < m_window)
+            return false;
+        m_avgMs = m_count ? m_sum / static_cast<float>(m_count) : 0.f;
+        m_maxMs = m_peak;
+        m_sum = 0.f;
+        m_peak = 0.f;
+        m_count = 0;
+        m_windowClock.restart();
+        return true;
+    }
+
+    float averageMs() const { return m_avgMs; }
+    float maxMs() const { return m_maxMs; }
+
+private:
+    float m_window;
+    sf::Clock m_frameClock;
+    sf::Clock m_windowClock;
+    float m_sum = 0.f;
+    float m_peak = 0.f;
+    std::size_t m_count = 0;
+    float m_avgMs = 0.f;
+    float m_maxMs = 0.f;
+};
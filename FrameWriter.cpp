@@ -0,0 +1,198 @@
+#include "FrameWriter.h"
+#include <SFML/Graphics.hpp>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#ifdef HAVE_LIBPNG
+#include <png.h>
+#endif
+
+namespace {
+bool writeFile(const std::string &path, const void *data, size_t size) {
+  FILE *fp = std::fopen(path.c_str(), "wb");
+  if (!fp)
+    return false;
+  bool ok = std::fwrite(data, 1, size, fp) == size;
+  return std::fclose(fp) == 0 && ok;
+}
+
+void putU32(std::vector<std::uint8_t> &out, std::uint32_t v) {
+  out.push_back(static_cast<std::uint8_t>(v >> 24));
+  out.push_back(static_cast<std::uint8_t>(v >> 16));
+  out.push_back(static_cast<std::uint8_t>(v >> 8));
+  out.push_back(static_cast<std::uint8_t>(v));
+}
+} // namespace
+
+bool FrameWriterOptions::parse(const std::string &name,
+                               FrameWriterOptions &out) {
+  if (name == "png") {
+    out = FrameWriterOptions();
+  } else if (name == "png-fast") {
+    out = FrameWriterOptions();
+    out.pngLevel = 1;
+    out.pngFilter = "none";
+  } else if (name == "qoi") {
+    out.format = FrameFormat::QOI;
+  } else if (name == "raw") {
+    out.format = FrameFormat::RAW;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::unique_ptr<FrameWriter>
+FrameWriter::create(const FrameWriterOptions &options) {
+  switch (options.format) {
+  case FrameFormat::QOI:
+    return std::make_unique<QoiFrameWriter>();
+  case FrameFormat::RAW:
+    return std::make_unique<RawFrameWriter>();
+  case FrameFormat::PNG:
+    break;
+  }
+  return std::make_unique<PngFrameWriter>(options.pngLevel, options.pngFilter);
+}
+
+bool FrameWriter::write(const RawFrame &frame, const std::string &path) const {
+  std::vector<std::uint8_t> out;
+  return encode(frame, out) && writeFile(path, out.data(), out.size());
+}
+
+bool QoiFrameWriter::encode(const RawFrame &frame,
+                            std::vector<std::uint8_t> &out) const {
+  enum : std::uint8_t {
+    OP_INDEX = 0x00,
+    OP_DIFF = 0x40,
+    OP_LUMA = 0x80,
+    OP_RUN = 0xc0,
+    OP_RGB = 0xfe,
+    OP_RGBA = 0xff
+  };
+  const size_t pixels = static_cast<size_t>(frame.width) * frame.height;
+  out.clear();
+  out.reserve(14 + pixels + 8);
+  out.insert(out.end(), {'q', 'o', 'i', 'f'});
+  putU32(out, frame.width);
+  putU32(out, frame.height);
+  out.push_back(4); // RGBA
+  out.push_back(0); // sRGB
+
+  std::uint8_t index[64][4] = {};
+  std::uint8_t prev[4] = {0, 0, 0, 255};
+  int run = 0;
+  const std::uint8_t *px = frame.pixels.data();
+  for (size_t i = 0; i < pixels; ++i, px += 4) {
+    if (std::memcmp(px, prev, 4) == 0) {
+      if (++run == 62 || i + 1 == pixels) {
+        out.push_back(static_cast<std::uint8_t>(OP_RUN | (run - 1)));
+        run = 0;
+      }
+      continue;
+    }
+    if (run > 0) {
+      out.push_back(static_cast<std::uint8_t>(OP_RUN | (run - 1)));
+      run = 0;
+    }
+    const int slot = (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64;
+    if (std::memcmp(index[slot], px, 4) == 0) {
+      out.push_back(static_cast<std::uint8_t>(OP_INDEX | slot));
+    } else {
+      std::memcpy(index[slot], px, 4);
+      if (px[3] == prev[3]) {
+        const int dr = static_cast<std::int8_t>(px[0] - prev[0]);
+        const int dg = static_cast<std::int8_t>(px[1] - prev[1]);
+        const int db = static_cast<std::int8_t>(px[2] - prev[2]);
+        const int drg = dr - dg;
+        const int dbg = db - dg;
+        if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2) {
+          out.push_back(static_cast<std::uint8_t>(
+              OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+        } else if (drg > -9 && drg < 8 && dg > -33 && dg < 32 && dbg > -9 &&
+                   dbg < 8) {
+          out.push_back(static_cast<std::uint8_t>(OP_LUMA | (dg + 32)));
+          out.push_back(static_cast<std::uint8_t>((drg + 8) << 4 | (dbg + 8)));
+        } else {
+          out.insert(out.end(), {OP_RGB, px[0], px[1], px[2]});
+        }
+      } else {
+        out.insert(out.end(), {OP_RGBA, px[0], px[1], px[2], px[3]});
+      }
+    }
+    std::memcpy(prev, px, 4);
+  }
+  out.insert(out.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+  return true;
+}
+
+bool RawFrameWriter::encode(const RawFrame &frame,
+                            std::vector<std::uint8_t> &out) const {
+  out.assign(frame.pixels.begin(), frame.pixels.begin() + frame.bytes());
+  return true;
+}
+
+bool RawFrameWriter::write(const RawFrame &frame,
+                           const std::string &path) const {
+  return writeFile(path, frame.pixels.data(), frame.bytes());
+}
+
+bool PngFrameWriter::encode(const RawFrame &frame,
+                            std::vector<std::uint8_t> &out) const {
+#ifdef HAVE_LIBPNG
+  out.clear();
+  png_structp png =
+      png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+  png_infop info = png ? png_create_info_struct(png) : nullptr;
+  if (!info || setjmp(png_jmpbuf(png))) {
+    png_destroy_write_struct(&png, info ? &info : nullptr);
+    return false;
+  }
+  png_set_write_fn(
+      png, &out,
+      [](png_structp p, png_bytep data, png_size_t size) {
+        auto *buf = static_cast<std::vector<std::uint8_t> *>(png_get_io_ptr(p));
+        buf->insert(buf->end(), data, data + size);
+      },
+      // Sem flush: o padrao da libpng trataria o ponteiro como FILE*.
+      [](png_structp) {});
+  png_set_compression_level(png, m_level);
+  int filters = PNG_ALL_FILTERS;
+  if (m_filter == "none")
+    filters = PNG_FILTER_NONE;
+  else if (m_filter == "sub")
+    filters = PNG_FILTER_SUB;
+  else if (m_filter == "up")
+    filters = PNG_FILTER_UP;
+  else if (m_filter == "avg")
+    filters = PNG_FILTER_AVG;
+  else if (m_filter == "paeth")
+    filters = PNG_FILTER_PAETH;
+  png_set_filter(png, PNG_FILTER_TYPE_BASE, filters);
+  png_set_IHDR(png, info, frame.width, frame.height, 8, PNG_COLOR_TYPE_RGBA,
+               PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE,
+               PNG_FILTER_TYPE_BASE);
+  png_write_info(png, info);
+  const size_t stride = static_cast<size_t>(frame.width) * 4;
+  for (unsigned y = 0; y < frame.height; ++y)
+    png_write_row(png, frame.pixels.data() + y * stride);
+  png_write_end(png, nullptr);
+  png_destroy_write_struct(&png, &info);
+  return true;
+#else
+  (void)frame;
+  (void)out;
+  return false;
+#endif
+}
+
+bool PngFrameWriter::write(const RawFrame &frame,
+                           const std::string &path) const {
+#ifdef HAVE_LIBPNG
+  return FrameWriter::write(frame, path);
+#else
+  sf::Image img;
+  img.create(frame.width, frame.height, frame.pixels.data());
+  return img.saveToFile(path);
+#endif
+}
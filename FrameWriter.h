@@ -0,0 +1,65 @@
+#pragma once
+#include "RawFrame.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class FrameFormat { PNG, QOI, RAW };
+
+struct FrameWriterOptions {
+    FrameFormat format = FrameFormat::PNG;
+    // PNG (com libpng): nivel zlib 0-9 e filtro de linha ("none", "sub",
+    // "up", "avg", "paeth", "all"); sem libpng usa o padrao do SFML.
+    int pngLevel = 6;
+    std::string pngFilter = "all";
+
+    // "png", "png-fast" (nivel 1, sem filtro), "qoi" ou "raw".
+    static bool parse(const std::string& name, FrameWriterOptions& out);
+};
+
+// Grava um frame RGBA num arquivo. Implementacoes sao sem estado e podem
+// ser chamadas de varias threads ao mesmo tempo.
+class FrameWriter {
+public:
+    virtual ~FrameWriter() = default;
+    virtual const char* extension() const = 0;
+    // Arquivo completo em memoria, para a escrita ir a uma fila de I/O
+    // separada da codificacao. false = so sabe gravar direto (write()).
+    virtual bool encode(const RawFrame&, std::vector<std::uint8_t>&) const { return false; }
+    // Padrao: encode() e um unico write do buffer.
+    virtual bool write(const RawFrame& frame, const std::string& path) const;
+    // O ffmpeg le o arquivo sozinho (image2/concat), sem tamanho externo.
+    virtual bool selfDescribing() const { return true; }
+
+    static std::unique_ptr<FrameWriter> create(const FrameWriterOptions& options);
+};
+
+// Formato de arquivo rapido e sem perda (https://qoiformat.org); o ffmpeg
+// decodifica desde a 5.1.
+class QoiFrameWriter : public FrameWriter {
+public:
+    const char* extension() const override { return "qoi"; }
+    bool encode(const RawFrame& frame, std::vector<std::uint8_t>& out) const override;
+};
+
+// Pixels RGBA crus, sem cabecalho: custo zero de codificacao.
+class RawFrameWriter : public FrameWriter {
+public:
+    const char* extension() const override { return "rgba"; }
+    bool encode(const RawFrame& frame, std::vector<std::uint8_t>& out) const override;
+    bool write(const RawFrame& frame, const std::string& path) const override;
+    bool selfDescribing() const override { return false; }
+};
+
+class PngFrameWriter : public FrameWriter {
+public:
+    PngFrameWriter(int level, const std::string& filter) : m_level(level), m_filter(filter) {}
+    const char* extension() const override { return "png"; }
+    // Em memoria so com libpng; sem ela o SFML grava direto no arquivo.
+    bool encode(const RawFrame& frame, std::vector<std::uint8_t>& out) const override;
+    bool write(const RawFrame& frame, const std::string& path) const override;
+
+private:
+    int m_level;
+    std::string m_filter;
+};
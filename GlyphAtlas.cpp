@@ -0,0 +1,159 @@
+#include "GlyphAtlas.h"
+#include <algorithm>
+
+namespace {
+const char GLYPH_CHARS[] = "0123456789-[]";
+constexpr std::uint8_t MINUS = 10;
+constexpr std::uint8_t LBRACKET = 11;
+constexpr std::uint8_t RBRACKET = 12;
+constexpr unsigned PADDING = 2;
+} // namespace
+
+void GlyphAtlas::bake() {
+  const sf::Font &font = m_font;
+  const unsigned characterSize = m_characterSize;
+  m_baked = true;
+  // Carrega os glifos na pagina da fonte antes de copiar a textura dela.
+  for (std::size_t i = 0; i < GLYPH_COUNT; ++i)
+    font.getGlyph(static_cast<sf::Uint32>(GLYPH_CHARS[i]), characterSize,
+                  false);
+  sf::Image page = font.getTexture(characterSize).copyToImage();
+
+  unsigned width = PADDING;
+  unsigned height = 1;
+  for (std::size_t i = 0; i < GLYPH_COUNT; ++i) {
+    const sf::Glyph &g =
+        font.getGlyph(static_cast<sf::Uint32>(GLYPH_CHARS[i]), characterSize,
+                      false);
+    width += static_cast<unsigned>(g.textureRect.width) + PADDING;
+    height = std::max(height, static_cast<unsigned>(g.textureRect.height) +
+                                  2 * PADDING);
+  }
+
+  sf::Image atlas;
+  atlas.create(width, height, sf::Color(255, 255, 255, 0));
+  unsigned x = PADDING;
+  for (std::size_t i = 0; i < GLYPH_COUNT; ++i) {
+    const sf::Glyph &g =
+        font.getGlyph(static_cast<sf::Uint32>(GLYPH_CHARS[i]), characterSize,
+                      false);
+    GlyphInfo &info = m_glyphs[i];
+    info.advance = g.advance;
+    info.bounds = g.bounds;
+    info.texRect = sf::FloatRect(static_cast<float>(x),
+                                 static_cast<float>(PADDING),
+                                 static_cast<float>(g.textureRect.width),
+                                 static_cast<float>(g.textureRect.height));
+    if (g.textureRect.width > 0 && g.textureRect.height > 0)
+      atlas.copy(page, x, PADDING, g.textureRect);
+    x += static_cast<unsigned>(g.textureRect.width) + PADDING;
+
+    for (std::size_t j = 0; j < GLYPH_COUNT; ++j)
+      m_kerning[i][j] =
+          font.getKerning(static_cast<sf::Uint32>(GLYPH_CHARS[i]),
+                          static_cast<sf::Uint32>(GLYPH_CHARS[j]),
+                          characterSize);
+  }
+  m_texture.loadFromImage(atlas);
+  m_texture.setSmooth(false);
+}
+
+void GlyphAtlas::buildLayout(Layout &out, long long value,
+                             bool bracketed) const {
+  std::array<std::uint8_t, MAX_GLYPHS> digits{};
+  std::size_t n = 0;
+  unsigned long long mag =
+      value < 0 ? 0ull - static_cast<unsigned long long>(value)
+                : static_cast<unsigned long long>(value);
+  do {
+    digits[n++] = static_cast<std::uint8_t>(mag % 10);
+    mag /= 10;
+  } while (mag > 0);
+
+  out.count = 0;
+  if (bracketed)
+    out.glyphs[out.count++] = LBRACKET;
+  if (value < 0)
+    out.glyphs[out.count++] = MINUS;
+  while (n > 0)
+    out.glyphs[out.count++] = digits[--n];
+  if (bracketed)
+    out.glyphs[out.count++] = RBRACKET;
+
+  float pen = 0.f;
+  float minX = 0.f, minY = 0.f, maxX = 0.f, maxY = 0.f;
+  bool first = true;
+  for (std::size_t i = 0; i < out.count; ++i) {
+    std::uint8_t gi = out.glyphs[i];
+    if (i > 0)
+      pen += m_kerning[out.glyphs[i - 1]][gi];
+    out.penX[i] = pen;
+    const sf::FloatRect &b = m_glyphs[gi].bounds;
+    if (b.width > 0.f && b.height > 0.f) {
+      float l = pen + b.left, t = b.top;
+      float r = l + b.width, btm = t + b.height;
+      if (first) {
+        minX = l; minY = t; maxX = r; maxY = btm;
+        first = false;
+      } else {
+        minX = std::min(minX, l); minY = std::min(minY, t);
+        maxX = std::max(maxX, r); maxY = std::max(maxY, btm);
+      }
+    }
+    pen += m_glyphs[gi].advance;
+  }
+  out.ink = sf::FloatRect(minX, minY, maxX - minX, maxY - minY);
+}
+
+const GlyphAtlas::Layout &
+GlyphAtlas::layoutFor(std::unordered_map<long long, Layout> &cache,
+                      long long key, long long value, bool bracketed) {
+  if (!m_baked)
+    bake();
+  auto it = cache.find(key);
+  if (it != cache.end())
+    return it->second;
+  if (cache.size() >= MAX_CACHED_LAYOUTS)
+    cache.clear();
+  Layout &layout = cache[key];
+  buildLayout(layout, value, bracketed);
+  return layout;
+}
+
+void GlyphAtlas::emit(sf::VertexArray &tris, const Layout &layout,
+                      sf::Vector2f origin, sf::Color color) const {
+  for (std::size_t i = 0; i < layout.count; ++i) {
+    const GlyphInfo &g = m_glyphs[layout.glyphs[i]];
+    if (g.texRect.width <= 0.f || g.texRect.height <= 0.f)
+      continue;
+    float l = origin.x + layout.penX[i] + g.bounds.left;
+    float t = origin.y + g.bounds.top;
+    float r = l + g.bounds.width;
+    float b = t + g.bounds.height;
+    float u0 = g.texRect.left, v0 = g.texRect.top;
+    float u1 = u0 + g.texRect.width, v1 = v0 + g.texRect.height;
+    tris.append(sf::Vertex({l, t}, color, {u0, v0}));
+    tris.append(sf::Vertex({r, t}, color, {u1, v0}));
+    tris.append(sf::Vertex({r, b}, color, {u1, v1}));
+    tris.append(sf::Vertex({l, t}, color, {u0, v0}));
+    tris.append(sf::Vertex({r, b}, color, {u1, v1}));
+    tris.append(sf::Vertex({l, b}, color, {u0, v1}));
+  }
+}
+
+void GlyphAtlas::appendNumber(sf::VertexArray &tris, long long value,
+                              sf::Vector2f center, sf::Color color) {
+  const Layout &layout = layoutFor(m_numberLayouts, value, value, false);
+  sf::Vector2f origin(center.x - (layout.ink.left + layout.ink.width / 2.f),
+                      center.y - (layout.ink.top + layout.ink.height / 2.f));
+  emit(tris, layout, origin, color);
+}
+
+void GlyphAtlas::appendIndex(sf::VertexArray &tris, std::size_t index,
+                             sf::Vector2f topCenter, sf::Color color) {
+  long long key = static_cast<long long>(index);
+  const Layout &layout = layoutFor(m_indexLayouts, key, key, true);
+  sf::Vector2f origin(topCenter.x - (layout.ink.left + layout.ink.width / 2.f),
+                      topCenter.y - layout.ink.top);
+  emit(tris, layout, origin, color);
+}
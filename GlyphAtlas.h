@@ -0,0 +1,55 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+
+// Atlas com os glifos numericos ("0-9", '-', '[', ']') de uma fonte em um
+// unico tamanho. Gera quads texturizados direto em um vertex array
+// (sf::Triangles), sem std::string nem sf::Text no caminho de desenho.
+// O atlas so e montado no primeiro uso, pois exige um contexto OpenGL.
+class GlyphAtlas {
+public:
+    GlyphAtlas(const sf::Font& font, unsigned characterSize)
+        : m_font(font), m_characterSize(characterSize) {}
+
+    const sf::Texture& texture() const { return m_texture; }
+
+    // Numero centralizado (tinta) em center, como sf::Text com origem no centro.
+    void appendNumber(sf::VertexArray& tris, long long value, sf::Vector2f center, sf::Color color);
+    // Rotulo "[i]" centralizado em x com o topo da tinta em topCenter.y.
+    void appendIndex(sf::VertexArray& tris, std::size_t index, sf::Vector2f topCenter, sf::Color color);
+
+private:
+    static constexpr std::size_t GLYPH_COUNT = 13; // 0-9 - [ ]
+    static constexpr std::size_t MAX_GLYPHS = 24;
+    static constexpr std::size_t MAX_CACHED_LAYOUTS = 4096;
+
+    struct GlyphInfo {
+        float advance = 0.f;
+        sf::FloatRect bounds;   // relativo a caneta/baseline
+        sf::FloatRect texRect;  // em pixels do atlas
+    };
+
+    struct Layout {
+        std::array<std::uint8_t, MAX_GLYPHS> glyphs{};
+        std::array<float, MAX_GLYPHS> penX{};
+        std::uint8_t count = 0;
+        sf::FloatRect ink;      // caixa da tinta relativa a caneta/baseline
+    };
+
+    void bake();
+    const Layout& layoutFor(std::unordered_map<long long, Layout>& cache, long long key,
+                            long long value, bool bracketed);
+    void buildLayout(Layout& out, long long value, bool bracketed) const;
+    void emit(sf::VertexArray& tris, const Layout& layout, sf::Vector2f origin, sf::Color color) const;
+
+    const sf::Font& m_font;
+    unsigned m_characterSize;
+    bool m_baked = false;
+    std::array<GlyphInfo, GLYPH_COUNT> m_glyphs;
+    std::array<std::array<float, GLYPH_COUNT>, GLYPH_COUNT> m_kerning{};
+    sf::Texture m_texture;
+    std::unordered_map<long long, Layout> m_numberLayouts;
+    std::unordered_map<long long, Layout> m_indexLayouts;
+};
@@ -0,0 +1,416 @@
+#include "HeadlessRunner.h"
+#include "CaptureService.h"
+#include "CommandLog.h"
+#include "CommandRecorder.h"
+#include "LinkedListVisualizer.h"
+#include "LiveVideoSink.h"
+#include "RandomProvider.h"
+#include "StructureController.h"
+#include "StructureFactory.h"
+#include "VectorVisualizer.h"
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+using SteadyClock = std::chrono::steady_clock;
+
+double msSince(SteadyClock::time_point start) {
+  return std::chrono::duration<double, std::milli>(SteadyClock::now() - start)
+      .count();
+}
+
+bool endsWith(const std::string &s, const std::string &suffix) {
+  return s.size() >= suffix.size() &&
+         s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+void printState(const char *name, const AbstractDataStructure *structure) {
+  std::cout << "[Headless] " << name << " (" << (structure ? structure->size() : 0)
+            << "): [";
+  if (structure) {
+    const auto &state = structure->getState();
+    const size_t shown = std::min<size_t>(state.size(), 32);
+    for (size_t i = 0; i < shown; ++i)
+      std::cout << (i ? ", " : "") << state[i];
+    if (shown < state.size())
+      std::cout << ", ...";
+  }
+  std::cout << "]\n";
+}
+
+bool sameCommand(const RecordedCommand &a, const RecordedCommand &b) {
+  // O .cmdlog guarda o tempo em microssegundos.
+  return a.op == b.op && a.target == b.target && a.index == b.index &&
+         a.hasValue == b.hasValue && (!a.hasValue || a.value == b.value) &&
+         std::fabs(a.t - b.t) <= 1e-6;
+}
+
+// Ida e volta do formato binario: grava os comandos num .cmdlog temporario,
+// reabre, confere a leitura sequencial e depois seek() (e loadBinary com
+// fromSeconds) em tempos espalhados contra a propria leitura sequencial.
+bool checkCommandLog(const CommandRecorder &recorder) {
+  const auto &cmds = recorder.get();
+  std::error_code ec;
+  const std::filesystem::path path =
+      std::filesystem::temp_directory_path(ec) / "visualizador-check.cmdlog";
+  if (ec || !CommandLog::write(path.string(), recorder.seed(), cmds)) {
+    std::cerr << "[Headless] Falha ao gravar " << path << '\n';
+    return false;
+  }
+
+  CommandLog log;
+  bool ok = log.open(path.string()) && log.size() == cmds.size() &&
+            log.seed() == recorder.seed();
+  // Maior tempo ate cada registro: seek() para no primeiro registro (na
+  // ordem do arquivo) que alcanca o tempo, mesmo fora de ordem.
+  std::vector<std::int64_t> reachedUs;
+  reachedUs.reserve(cmds.size());
+  RecordedCommand rc;
+  if (ok) {
+    CommandLog::Cursor cursor = log.begin();
+    while (ok && cursor.next(rc)) {
+      ok = reachedUs.size() < cmds.size() &&
+           sameCommand(rc, cmds[reachedUs.size()]);
+      const auto us = static_cast<std::int64_t>(std::llround(rc.t * 1e6));
+      reachedUs.push_back(reachedUs.empty() ? us
+                                            : std::max(reachedUs.back(), us));
+    }
+    ok = ok && !cursor.failed() && reachedUs.size() == cmds.size();
+  }
+  if (!ok)
+    std::cerr << "[Headless] Leitura sequencial do .cmdlog difere dos "
+                 "comandos carregados\n";
+
+  const int samples = 256;
+  const double span = log.duration() * 1.05;
+  size_t seeks = 0;
+  for (int k = 0; ok && k <= samples; ++k) {
+    // Metade dos pontos cai exatamente no tempo de um comando.
+    const double s = k % 2 || cmds.empty()
+                         ? span * k / samples
+                         : cmds[cmds.size() * k / (samples + 1)].t;
+    const std::int64_t target = std::llround(s * 1e6);
+    const size_t expected = static_cast<size_t>(
+        std::lower_bound(reachedUs.begin(), reachedUs.end(), target) -
+        reachedUs.begin());
+    CommandLog::Cursor cursor = log.seek(s);
+    ok = !cursor.failed() && cursor.position() == expected &&
+         (expected == cmds.size()
+              ? !cursor.next(rc)
+              : cursor.next(rc) && sameCommand(rc, cmds[expected]));
+    if (ok && k == samples / 2) {
+      CommandRecorder partial;
+      ok = partial.loadBinary(path.string(), s) &&
+           partial.get().size() == cmds.size() - expected;
+    }
+    if (!ok)
+      std::cerr << "[Headless] seek(" << s << ") difere: esperado registro "
+                << expected << ", cursor em " << cursor.position() << '\n';
+    ++seeks;
+  }
+
+  const auto bytes = std::filesystem::file_size(path, ec);
+  log.close();
+  std::filesystem::remove(path, ec);
+  if (ok)
+    std::cout << "[Headless] .cmdlog conferido: " << cmds.size()
+              << " comandos, " << seeks << " seeks, " << bytes << " bytes\n";
+  return ok;
+}
+
+bool parseSize(const char *text, unsigned &w, unsigned &h) {
+  if (std::sscanf(text, "%ux%u", &w, &h) != 2 || w == 0 || h == 0) {
+    std::cerr << "[Headless] Tamanho invalido: " << text << '\n';
+    return false;
+  }
+  return true;
+}
+} // namespace
+
+bool HeadlessRunner::isHeadless(int argc, char **argv) {
+  for (int i = 1; i < argc; ++i)
+    if (std::strcmp(argv[i], "--headless") == 0)
+      return true;
+  return false;
+}
+
+void HeadlessRunner::printUsage() {
+  std::cout << "Uso: visualizador --headless [--commands arquivo] "
+               "[--no-render] [--size LxA] [--fps N]\n"
+               "                  [--frames dir] [--capture-mb N] [--spill-mb N] "
+               "[--frame-format png|png-fast|qoi|raw]\n"
+               "                  [--capture-fps N] [--capture-scale F]"
+               " [--tail segundos] [--from segundos]"
+               " [--video saida.mp4] [--video-size LxA]\n"
+               "                  [--preset ultrafast|veryfast|...]\n"
+               "       visualizador --headless --check-log [--commands "
+               "arquivo]\n";
+}
+
+bool HeadlessRunner::parseArgs(int argc, char **argv, HeadlessOptions &out) {
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--headless") {
+      continue;
+    } else if (arg == "--no-render") {
+      out.render = false;
+    } else if (arg == "--commands" && hasValue) {
+      out.commandFile = argv[++i];
+    } else if (arg == "--size" && hasValue) {
+      if (!parseSize(argv[++i], out.width, out.height))
+        return false;
+    } else if (arg == "--video" && hasValue) {
+      out.videoFile = argv[++i];
+    } else if (arg == "--video-size" && hasValue) {
+      if (!parseSize(argv[++i], out.videoWidth, out.videoHeight))
+        return false;
+    } else if (arg == "--preset" && hasValue) {
+      out.videoPreset = argv[++i];
+    } else if (arg == "--fps" && hasValue) {
+      out.fps = std::strtof(argv[++i], nullptr);
+    } else if (arg == "--frames" && hasValue) {
+      out.framesDir = argv[++i];
+    } else if (arg == "--frame-format" && hasValue) {
+      FrameWriterOptions format;
+      if (!FrameWriterOptions::parse(argv[++i], format)) {
+        std::cerr << "[Headless] Formato de frame invalido: " << argv[i] << '\n';
+        return false;
+      }
+      out.frameFormat = argv[i];
+    } else if (arg == "--capture-mb" && hasValue) {
+      out.captureMB = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--capture-fps" && hasValue) {
+      out.captureFps = std::strtof(argv[++i], nullptr);
+    } else if (arg == "--capture-scale" && hasValue) {
+      out.captureScale = std::strtof(argv[++i], nullptr);
+    } else if (arg == "--spill-mb" && hasValue) {
+      out.spillMB = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--tail" && hasValue) {
+      out.tailSeconds = std::strtof(argv[++i], nullptr);
+    } else if (arg == "--from" && hasValue) {
+      out.fromSeconds = std::strtod(argv[++i], nullptr);
+    } else if (arg == "--check-log") {
+      out.checkLog = true;
+    } else {
+      std::cerr << "[Headless] Argumento desconhecido: " << arg << '\n';
+      printUsage();
+      return false;
+    }
+  }
+  if (out.fromSeconds < 0.0) {
+    std::cerr << "[Headless] from deve ser >= 0." << '\n';
+    return false;
+  }
+  if (out.fps <= 0.f || out.captureMB == 0) {
+    std::cerr << "[Headless] fps e capture-mb devem ser positivos." << '\n';
+    return false;
+  }
+  if (out.captureFps < 0.f || out.captureScale <= 0.f || out.captureScale > 1.f) {
+    std::cerr << "[Headless] capture-fps deve ser >= 0 e capture-scale em (0, 1]."
+              << '\n';
+    return false;
+  }
+  return true;
+}
+
+int HeadlessRunner::run() {
+  const HeadlessOptions &opt = m_options;
+
+  // O .cmdlog vai pelo indice direto ao primeiro comando de --from; os
+  // outros formatos carregam tudo e pulam os anteriores no replay.
+  const bool binary = endsWith(opt.commandFile, ".cmdlog");
+  const double from = opt.checkLog ? 0.0 : opt.fromSeconds;
+  CommandRecorder recorder;
+  bool loaded = endsWith(opt.commandFile, ".json")
+                    ? recorder.loadJSON(opt.commandFile)
+                : binary ? recorder.loadBinary(opt.commandFile, from)
+                         : recorder.load(opt.commandFile);
+  if (!loaded) {
+    std::cerr << "[Headless] Falha ao carregar " << opt.commandFile << '\n';
+    return 1;
+  }
+  if (opt.checkLog)
+    return checkCommandLog(recorder) ? 0 : 1;
+
+  sf::Font font;
+  if (!font.loadFromFile("arial.ttf")) {
+    std::cerr << "[Headless] Erro ao carregar fonte" << '\n';
+    return 1;
+  }
+
+  VectorVisualizer vecViz(font, {50.f, 150.f});
+  LinkedListVisualizer listViz(font, {50.f, 400.f});
+  RandomProvider rng;
+  if (recorder.seed())
+    rng.setSeed(recorder.seed());
+
+  StructureFactory factory;
+  StructureController controllerArray(factory.create("array_list"), &vecViz,
+                                      &rng);
+  StructureController controllerList(factory.create("linked_list"), &listViz,
+                                     &rng);
+  controllerArray.connect();
+  controllerList.connect();
+
+  // O layout continua em coordenadas width x height; a view escala para a
+  // resolucao de saida do video.
+  const bool video = opt.render && !opt.videoFile.empty();
+  const unsigned outW = video && opt.videoWidth ? opt.videoWidth : opt.width;
+  const unsigned outH = video && opt.videoHeight ? opt.videoHeight : opt.height;
+  sf::RenderTexture target;
+  if (opt.render) {
+    if (!target.create(outW, outH)) {
+      std::cerr << "[Headless] Falha ao criar RenderTexture " << outW << 'x'
+                << outH << " (sem contexto OpenGL? use --no-render)\n";
+      return 1;
+    }
+    target.setView(sf::View(sf::FloatRect(0.f, 0.f, static_cast<float>(opt.width),
+                                          static_cast<float>(opt.height))));
+  }
+  // Video e captura de frames dividem a mesma leitura do CaptureService:
+  // com PBO ela e assincrona, e o passo N entrega o frame N-1 enquanto a GPU
+  // copia o atual, sem o stall de copyToImage() a cada frame.
+  const bool capture = opt.render && !opt.framesDir.empty();
+  CaptureService captureService;
+  LiveVideoSink liveVideo;
+  if (video) {
+    if (!liveVideo.start(opt.videoFile, outW, outH, opt.fps, opt.videoPreset))
+      return 1;
+    captureService.subscribe(liveVideo);
+  }
+  bool videoOk = true;
+  if (capture) {
+    vecViz.setCaptureBudget(opt.captureMB << 20);
+    vecViz.setCaptureRate(opt.captureFps);
+    vecViz.setCaptureScale(opt.captureScale);
+    if (opt.spillMB > 0 && !vecViz.enableCaptureSpill(opt.spillMB << 20))
+      std::cerr << "[Headless] Spill em disco indisponivel; captura so em RAM\n";
+    FrameWriterOptions format;
+    FrameWriterOptions::parse(opt.frameFormat, format);
+    vecViz.setFrameFormat(format);
+    vecViz.setCaptureEnabled(true);
+    captureService.subscribe(vecViz.recorder());
+  }
+
+  const auto &cmds = recorder.get();
+  const float dt = 1.f / opt.fps;
+  const double endTime = (cmds.empty() ? 0.0 : cmds.back().t) + opt.tailSeconds;
+  // Protecao contra animacoes que nunca terminam: 10 min simulados extras.
+  const size_t frameLimit =
+      static_cast<size_t>((endTime + 600.0) * opt.fps) + 1;
+
+  // Com --from as estruturas partem vazias: so os comandos a partir dali
+  // sao reproduzidos, com o relogio comecando no proprio from.
+  double simTime = from;
+  size_t next = 0;
+  if (!binary)
+    while (next < cmds.size() && cmds[next].t < from)
+      ++next;
+  size_t frames = 0;
+  size_t skipped = 0;
+  size_t redrawn = 0;
+  double simulateMs = 0.0, drawMs = 0.0, captureMs = 0.0;
+  const auto wallStart = SteadyClock::now();
+
+  while (next < cmds.size() || vecViz.hasPendingWork() ||
+         listViz.hasPendingWork() || simTime < endTime) {
+    auto t0 = SteadyClock::now();
+    while (next < cmds.size() && cmds[next].t <= simTime) {
+      const auto &cmd = cmds[next++];
+      bool applied = false;
+      if (cmd.target == "vector")
+        applied = controllerArray.replay(cmd);
+      else if (cmd.target == "list")
+        applied = controllerList.replay(cmd);
+      if (!applied)
+        ++skipped;
+    }
+    vecViz.update(dt);
+    listViz.update(dt);
+    vecViz.reflow(static_cast<float>(opt.width));
+    listViz.reflow(static_cast<float>(opt.width));
+    simulateMs += msSince(t0);
+
+    // Passos sem mudanca reaproveitam o conteudo ja presente no target.
+    const bool changed =
+        frames == 0 || vecViz.needsRedraw() || listViz.needsRedraw();
+    if (opt.render && changed) {
+      auto t1 = SteadyClock::now();
+      target.clear(sf::Color(30, 30, 30));
+      vecViz.draw(target);
+      listViz.draw(target);
+      target.display();
+      ++redrawn;
+      drawMs += msSince(t1);
+    }
+    // Passos sem mudanca tambem sao lidos: o video precisa de um frame por
+    // passo, e a copia para o PBO nao segura a CPU.
+    if (capture || video) {
+      auto t2 = SteadyClock::now();
+      captureService.capture(target);
+      captureMs += msSince(t2);
+    }
+
+    simTime += dt;
+    if (video && liveVideo.failed()) {
+      videoOk = false;
+      std::cerr << "[Headless] Encoder falhou; interrompendo.\n";
+      break;
+    }
+    if (++frames >= frameLimit) {
+      std::cerr << "[Headless] Limite de frames atingido; interrompendo.\n";
+      break;
+    }
+  }
+  if (capture || video)
+    captureService.flush(target);
+  if (video && (!liveVideo.stop() || liveVideo.failed()))
+    videoOk = false;
+  const double wallMs = msSince(wallStart);
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "[Headless] " << cmds.size() << " comandos (" << skipped
+            << " ignorados), " << frames << " frames, " << simTime - from
+            << " s simulados em " << wallMs / 1000.0 << " s ("
+            << (wallMs > 0.0 ? (simTime - from) * 1000.0 / wallMs : 0.0)
+            << "x tempo real)\n";
+  if (frames > 0) {
+    std::cout << "[Headless] ms/frame: simulacao " << simulateMs / frames
+              << " | desenho " << drawMs / frames << " | leitura+video "
+              << captureMs / frames << " ("
+              << (captureService.asynchronous() ? "PBO" : "sincrona") << ", "
+              << redrawn << " frames redesenhados)\n";
+  }
+  printState("vector", controllerArray.structure());
+  printState("list", controllerList.structure());
+
+  if (video) {
+    if (!videoOk)
+      return 1;
+    std::cout << "[Headless] Video " << outW << 'x' << outH << " @ " << opt.fps
+              << " fps salvo em " << opt.videoFile << '\n';
+  }
+  if (capture) {
+    vecViz.clearSavedFrames(opt.framesDir);
+    if (!vecViz.saveFramesDAO(opt.framesDir))
+      return 1;
+    std::cout << "[Headless] " << vecViz.getCapturedFrameCount()
+              << " frames unicos de " << vecViz.getCaptureTickCount()
+              << " capturas salvos em " << opt.framesDir << " ("
+              << vecViz.getCaptureMemoryUsed() / 1048576.0
+              << " MB comprimidos em memoria, "
+              << vecViz.getCaptureSpilledBytes() / 1048576.0 << " MB em disco)\n";
+  }
+  return 0;
+}
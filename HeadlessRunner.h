@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <utility>
+
+struct HeadlessOptions {
+    std::string commandFile = "commands.json"; // .json/.cmdlog (temporal) ou log texto
+    bool render = true;          // false: so simulacao, nenhum recurso OpenGL
+    unsigned width = 1400;
+    unsigned height = 800;
+    float fps = 60.f;            // passo fixo da simulacao
+    std::string framesDir;       // vazio: nao captura/salva frames
+    std::string frameFormat = "png"; // png | png-fast | qoi | raw
+    size_t captureMB = 256;      // orcamento de memoria (comprimida) da captura
+    size_t spillMB = 0;          // >0: excedente da captura vai para disco (mmap)
+    float captureFps = 0.f;      // 0: captura todo passo da simulacao
+    float captureScale = 1.f;    // (0, 1]: reducao aplicada na captura
+    float tailSeconds = 0.f;     // tempo simulado extra apos o ultimo comando
+    double fromSeconds = 0.0;    // so reproduz comandos com t >= from (.cmdlog: via indice)
+    bool checkLog = false;       // grava/le/seek um .cmdlog dos comandos e compara
+    std::string videoFile;       // vazio: sem video; senao frames vao direto ao ffmpeg
+    unsigned videoWidth = 0;     // 0: mesmo tamanho do layout (width x height)
+    unsigned videoHeight = 0;
+    std::string videoPreset = "veryfast";
+};
+
+// Executa um log de comandos sem janela: controllers, visualizadores e
+// FrameRecorder rodam com passo fixo, o mais rapido que a CPU permitir,
+// desenhando num sf::RenderTexture (ou sem desenhar nada). Com --video, cada
+// passo vira um frame do video, independente do tamanho/fps da janela.
+class HeadlessRunner {
+public:
+    explicit HeadlessRunner(HeadlessOptions options) : m_options(std::move(options)) {}
+
+    int run();
+
+    static bool isHeadless(int argc, char** argv);
+    static bool parseArgs(int argc, char** argv, HeadlessOptions& out);
+    static void printUsage();
+
+private:
+    HeadlessOptions m_options;
+};
@@ -0,0 +1,261 @@
+#include "JsonSax.h"
+#include <algorithm>
+
+namespace {
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+int hexValue(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+void appendUtf8(std::string &out, unsigned cp) {
+  if (cp < 0x80) {
+    out += static_cast<char>(cp);
+  } else if (cp < 0x800) {
+    out += static_cast<char>(0xC0 | (cp >> 6));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  } else if (cp < 0x10000) {
+    out += static_cast<char>(0xE0 | (cp >> 12));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  } else {
+    out += static_cast<char>(0xF0 | (cp >> 18));
+    out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  }
+}
+} // namespace
+
+bool JsonSaxParser::fail(size_t offset, std::string message) {
+  // Linha/coluna so sao contadas quando ha erro, fora do caminho quente.
+  const auto begin = m_in.begin();
+  const auto at = begin + static_cast<std::ptrdiff_t>(std::min(offset, m_in.size()));
+  m_error.offset = offset;
+  m_error.line = 1 + static_cast<size_t>(std::count(begin, at, '\n'));
+  const auto lineStart =
+      std::find(std::make_reverse_iterator(at), m_in.rend(), '\n').base();
+  m_error.column = 1 + static_cast<size_t>(at - lineStart);
+  m_error.message = std::move(message);
+  return false;
+}
+
+void JsonSaxParser::skipSpace(size_t &pos) const {
+  while (pos < m_in.size() && (m_in[pos] == ' ' || m_in[pos] == '\n' ||
+                               m_in[pos] == '\r' || m_in[pos] == '\t'))
+    ++pos;
+}
+
+bool JsonSaxParser::scanNumber(size_t &pos) {
+  const size_t size = m_in.size();
+  size_t i = pos;
+  if (m_in[i] == '-')
+    ++i;
+  if (i >= size || !isDigit(m_in[i]))
+    return fail(i, "numero invalido");
+  if (m_in[i] == '0') {
+    ++i;
+  } else {
+    while (i < size && isDigit(m_in[i]))
+      ++i;
+  }
+  if (i < size && m_in[i] == '.') {
+    if (++i >= size || !isDigit(m_in[i]))
+      return fail(i, "esperado digito depois do '.'");
+    while (i < size && isDigit(m_in[i]))
+      ++i;
+  }
+  if (i < size && (m_in[i] == 'e' || m_in[i] == 'E')) {
+    ++i;
+    if (i < size && (m_in[i] == '+' || m_in[i] == '-'))
+      ++i;
+    if (i >= size || !isDigit(m_in[i]))
+      return fail(i, "expoente invalido");
+    while (i < size && isDigit(m_in[i]))
+      ++i;
+  }
+  pos = i;
+  return true;
+}
+
+bool JsonSaxParser::parseString(size_t &pos, std::string_view &out) {
+  const size_t size = m_in.size();
+  const size_t start = pos + 1;
+  size_t i = start;
+  // Caminho comum: sem escapes, a view aponta direto para a entrada.
+  while (i < size && m_in[i] != '"' && m_in[i] != '\\') {
+    if (static_cast<unsigned char>(m_in[i]) < 0x20)
+      return fail(i, "caractere de controle dentro de string");
+    ++i;
+  }
+  if (i >= size)
+    return fail(pos, "string sem aspas de fechamento");
+  if (m_in[i] == '"') {
+    out = m_in.substr(start, i - start);
+    pos = i + 1;
+    return true;
+  }
+
+  m_scratch.assign(m_in.data() + start, i - start);
+  auto hex4 = [&](size_t at, unsigned &cp) {
+    if (at + 4 > size)
+      return false;
+    cp = 0;
+    for (size_t k = 0; k < 4; ++k) {
+      const int v = hexValue(m_in[at + k]);
+      if (v < 0)
+        return false;
+      cp = cp << 4 | static_cast<unsigned>(v);
+    }
+    return true;
+  };
+  while (i < size && m_in[i] != '"') {
+    const char c = m_in[i];
+    if (static_cast<unsigned char>(c) < 0x20)
+      return fail(i, "caractere de controle dentro de string");
+    if (c != '\\') {
+      m_scratch += c;
+      ++i;
+      continue;
+    }
+    if (++i >= size)
+      break;
+    switch (m_in[i]) {
+    case '"': m_scratch += '"'; break;
+    case '\\': m_scratch += '\\'; break;
+    case '/': m_scratch += '/'; break;
+    case 'b': m_scratch += '\b'; break;
+    case 'f': m_scratch += '\f'; break;
+    case 'n': m_scratch += '\n'; break;
+    case 'r': m_scratch += '\r'; break;
+    case 't': m_scratch += '\t'; break;
+    case 'u': {
+      unsigned cp = 0;
+      if (!hex4(i + 1, cp))
+        return fail(i - 1, "escape \\u invalido");
+      i += 4;
+      if (cp >= 0xDC00 && cp <= 0xDFFF)
+        return fail(i - 5, "surrogate UTF-16 sem par");
+      if (cp >= 0xD800 && cp <= 0xDBFF) {
+        unsigned low = 0;
+        if (i + 2 >= size || m_in[i + 1] != '\\' || m_in[i + 2] != 'u' ||
+            !hex4(i + 3, low) || low < 0xDC00 || low > 0xDFFF)
+          return fail(i - 5, "surrogate UTF-16 sem par");
+        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+        i += 6;
+      }
+      appendUtf8(m_scratch, cp);
+      break;
+    }
+    default:
+      return fail(i - 1, "escape invalido");
+    }
+    ++i;
+  }
+  if (i >= size)
+    return fail(pos, "string sem aspas de fechamento");
+  out = m_scratch;
+  pos = i + 1;
+  return true;
+}
+
+bool JsonSaxParser::parse(std::string_view input, JsonSaxHandler &handler) {
+  m_in = input;
+  m_stack.clear();
+  m_error = JsonError();
+  enum class State { Value, Key, After };
+  State state = State::Value;
+  const size_t size = m_in.size();
+  size_t pos = 0;
+  if (m_in.substr(0, 3) == "\xEF\xBB\xBF") // BOM UTF-8
+    pos = 3;
+  auto ok = [&](size_t at, const char *err) { return !err || fail(at, err); };
+
+  for (;;) {
+    skipSpace(pos);
+    if (state == State::After) {
+      if (m_stack.empty())
+        return pos == size || fail(pos, "conteudo depois do fim do JSON");
+      if (pos >= size)
+        return fail(pos, "fim inesperado do arquivo");
+      const bool inObject = m_stack.back() == '{';
+      const char c = m_in[pos];
+      if (c == ',') {
+        ++pos;
+        state = inObject ? State::Key : State::Value;
+      } else if (c == (inObject ? '}' : ']')) {
+        m_stack.pop_back();
+        if (!ok(pos, inObject ? handler.endObject() : handler.endArray()))
+          return false;
+        ++pos;
+      } else {
+        return fail(pos, inObject ? "esperado ',' ou '}'" : "esperado ',' ou ']'");
+      }
+      continue;
+    }
+    if (pos >= size)
+      return fail(pos, "fim inesperado do arquivo");
+
+    const size_t at = pos;
+    if (state == State::Key) {
+      std::string_view key;
+      if (m_in[pos] != '"')
+        return fail(pos, "esperada chave entre aspas");
+      if (!parseString(pos, key) || !ok(at, handler.key(key)))
+        return false;
+      skipSpace(pos);
+      if (pos >= size || m_in[pos] != ':')
+        return fail(pos, "esperado ':'");
+      ++pos;
+      state = State::Value;
+      continue;
+    }
+
+    const char c = m_in[pos];
+    if (c == '{' || c == '[') {
+      const bool object = c == '{';
+      if (m_stack.size() >= MAX_DEPTH)
+        return fail(pos, "aninhamento profundo demais");
+      if (!ok(at, object ? handler.startObject() : handler.startArray()))
+        return false;
+      ++pos;
+      skipSpace(pos);
+      if (pos < size && m_in[pos] == (object ? '}' : ']')) {
+        if (!ok(pos, object ? handler.endObject() : handler.endArray()))
+          return false;
+        ++pos;
+        state = State::After;
+      } else {
+        m_stack.push_back(c);
+        state = object ? State::Key : State::Value;
+      }
+      continue;
+    }
+    if (c == '"') {
+      std::string_view s;
+      if (!parseString(pos, s) || !ok(at, handler.string(s)))
+        return false;
+    } else if (c == '-' || isDigit(c)) {
+      if (!scanNumber(pos) || !ok(at, handler.number(m_in.substr(at, pos - at))))
+        return false;
+    } else if (m_in.substr(pos, 4) == "true" || m_in.substr(pos, 5) == "false") {
+      const bool value = c == 't';
+      pos += value ? 4 : 5;
+      if (!ok(at, handler.boolean(value)))
+        return false;
+    } else if (m_in.substr(pos, 4) == "null") {
+      pos += 4;
+      if (!ok(at, handler.null()))
+        return false;
+    } else {
+      return fail(pos, "valor JSON esperado");
+    }
+    state = State::After;
+  }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Eventos do JsonSaxParser. Cada metodo devolve nullptr para continuar ou
+// a mensagem de erro, que sai com a posicao do token atual. Strings e
+// numeros chegam como views validas so durante a chamada: apontam direto
+// para o buffer de entrada (ou para um rascunho, se a string tem escapes).
+// Numeros vem crus, no formato JSON, para o handler converter com
+// std::from_chars no tipo que espera.
+class JsonSaxHandler {
+public:
+    virtual ~JsonSaxHandler() = default;
+    virtual const char* startObject() { return nullptr; }
+    virtual const char* endObject() { return nullptr; }
+    virtual const char* startArray() { return nullptr; }
+    virtual const char* endArray() { return nullptr; }
+    virtual const char* key(std::string_view) { return nullptr; }
+    virtual const char* string(std::string_view) { return nullptr; }
+    virtual const char* number(std::string_view) { return nullptr; }
+    virtual const char* boolean(bool) { return nullptr; }
+    virtual const char* null() { return nullptr; }
+};
+
+struct JsonError {
+    size_t offset = 0; // bytes desde o inicio
+    size_t line = 0;   // a partir de 1
+    size_t column = 0; // a partir de 1, em bytes
+    std::string message;
+};
+
+// Parser JSON (RFC 8259) de uma passada, sem montar arvore: memoria fixa
+// alem da pilha de aninhamento e do rascunho para strings com escape.
+class JsonSaxParser {
+public:
+    static constexpr size_t MAX_DEPTH = 256;
+
+    bool parse(std::string_view input, JsonSaxHandler& handler);
+    const JsonError& error() const { return m_error; }
+
+private:
+    bool fail(size_t offset, std::string message);
+    bool parseString(size_t& pos, std::string_view& out);
+    bool scanNumber(size_t& pos);
+    void skipSpace(size_t& pos) const;
+
+    std::string_view m_in;
+    std::vector<char> m_stack; // '{' ou '['
+    std::string m_scratch;
+    JsonError m_error;
+};
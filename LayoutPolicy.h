@@ -1,6 +1,8 @@
 #pragma once
 #include <SFML/Graphics.hpp>
+#include <algorithm>
 #include <cstddef>
+#include <utility>
 
 class ILayoutPolicy {
 public:
@@ -33,3 +35,29 @@ private:
     float m_ptrWidth;
     float m_spacing;
 };
+
+// Grade row-major produzida pelo reflow. Como a posicao de cada indice e
+// calculavel, da para descobrir quais indices caem numa faixa vertical sem
+// percorrer todos os nos.
+struct GridLayout {
+    sf::Vector2f origin;
+    std::size_t cols = 1;
+    float stride = 0.f;
+    float rowHeight = 0.f;
+
+    sf::Vector2f positionForIndex(std::size_t i) const {
+        return { origin.x + static_cast<float>(i % cols) * stride,
+                 origin.y + static_cast<float>(i / cols) * rowHeight };
+    }
+    std::size_t rowCount(std::size_t count) const { return (count + cols - 1) / cols; }
+    // Linhas [first, last) que intersectam [top, bottom).
+    std::pair<std::size_t, std::size_t> rowSpan(float top, float bottom, std::size_t count) const {
+        std::size_t rows = rowCount(count);
+        if (rowHeight <= 0.f || bottom <= origin.y) return {0, 0};
+        float first = std::max(0.f, (top - origin.y) / rowHeight);
+        float last = std::max(0.f, (bottom - origin.y) / rowHeight + 1.f);
+        std::size_t f = std::min(rows, static_cast<std::size_t>(first));
+        std::size_t l = std::min(rows, static_cast<std::size_t>(last));
+        return {f, std::max(f, l)};
+    }
+};
@@ -0,0 +1,191 @@
+#ifdef HAVE_LIBAV
+#include "LibavEncoder.h"
+#include <cstring>
+#include <iostream>
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/opt.h>
+#include <libswscale/swscale.h>
+}
+
+namespace {
+std::string errorText(int err) {
+  char buf[AV_ERROR_MAX_STRING_SIZE] = {0};
+  av_strerror(err, buf, sizeof(buf));
+  return buf;
+}
+} // namespace
+
+LibavEncoder::~LibavEncoder() {
+  close();
+  release();
+}
+
+bool LibavEncoder::start(const std::string &outputFile, unsigned width,
+                         unsigned height, double fps,
+                         const std::string &preset) {
+  int err = avformat_alloc_output_context2(&m_format, nullptr, nullptr,
+                                           outputFile.c_str());
+  if (err < 0 || !m_format) {
+    std::cerr << "[LibavEncoder] Formato de saida invalido para " << outputFile
+              << ": " << errorText(err) << '\n';
+    return false;
+  }
+  const AVCodec *codec = avcodec_find_encoder_by_name("libx264");
+  if (!codec)
+    codec = avcodec_find_encoder(AV_CODEC_ID_H264);
+  if (!codec) {
+    std::cerr << "[LibavEncoder] Encoder H.264 indisponivel." << '\n';
+    release();
+    return false;
+  }
+  m_stream = avformat_new_stream(m_format, nullptr);
+  m_codec = avcodec_alloc_context3(codec);
+  if (!m_stream || !m_codec) {
+    release();
+    return false;
+  }
+  const AVRational rate = av_d2q(fps, 100000);
+  m_srcWidth = static_cast<int>(width);
+  m_srcHeight = static_cast<int>(height);
+  m_codec->width = (m_srcWidth + 1) & ~1;
+  m_codec->height = (m_srcHeight + 1) & ~1;
+  m_codec->time_base = av_inv_q(rate);
+  m_codec->framerate = rate;
+  m_codec->pix_fmt = AV_PIX_FMT_YUV420P;
+  if (m_format->oformat->flags & AVFMT_GLOBALHEADER)
+    m_codec->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+  av_opt_set(m_codec->priv_data, "preset", preset.c_str(), 0);
+
+  err = avcodec_open2(m_codec, codec, nullptr);
+  if (err < 0) {
+    std::cerr << "[LibavEncoder] avcodec_open2: " << errorText(err) << '\n';
+    release();
+    return false;
+  }
+  avcodec_parameters_from_context(m_stream->codecpar, m_codec);
+  m_stream->time_base = m_codec->time_base;
+
+  err = avio_open(&m_format->pb, outputFile.c_str(), AVIO_FLAG_WRITE);
+  if (err >= 0)
+    err = avformat_write_header(m_format, nullptr);
+  if (err < 0) {
+    std::cerr << "[LibavEncoder] Falha ao abrir " << outputFile << ": "
+              << errorText(err) << '\n';
+    release();
+    return false;
+  }
+
+  m_frame = av_frame_alloc();
+  m_packet = av_packet_alloc();
+  if (!m_frame || !m_packet) {
+    release();
+    return false;
+  }
+  m_frame->format = m_codec->pix_fmt;
+  m_frame->width = m_codec->width;
+  m_frame->height = m_codec->height;
+  if (av_frame_get_buffer(m_frame, 0) < 0) {
+    release();
+    return false;
+  }
+  // Converte so a area da captura; padEdges() preenche a borda par.
+  m_sws = sws_getContext(m_srcWidth, m_srcHeight, AV_PIX_FMT_RGBA, m_srcWidth,
+                         m_srcHeight, AV_PIX_FMT_YUV420P, SWS_BILINEAR,
+                         nullptr, nullptr, nullptr);
+  if (!m_sws) {
+    release();
+    return false;
+  }
+  m_pts = 0;
+  m_bytes = 0;
+  std::cout << "[LibavEncoder] " << codec->name << ' ' << width << 'x'
+            << height << " @ " << fps << " fps -> " << outputFile << '\n';
+  return true;
+}
+
+bool LibavEncoder::write(const std::vector<std::uint8_t> &frame) {
+  // O encoder pode ainda referenciar os planos do frame anterior.
+  if (av_frame_make_writable(m_frame) < 0)
+    return false;
+  const std::uint8_t *src[1] = {frame.data()};
+  const int srcStride[1] = {m_srcWidth * 4};
+  sws_scale(m_sws, src, srcStride, 0, m_srcHeight, m_frame->data,
+            m_frame->linesize);
+  padEdges();
+  m_frame->pts = m_pts++;
+  return encode(m_frame);
+}
+
+void LibavEncoder::padEdges() {
+  // Croma ja cobre a borda: com largura/altura impar o sws gera
+  // ceil(n/2) amostras, o mesmo que o codec par espera.
+  std::uint8_t *luma = m_frame->data[0];
+  const int stride = m_frame->linesize[0];
+  if (m_codec->width != m_srcWidth) {
+    for (int y = 0; y < m_srcHeight; ++y)
+      luma[y * stride + m_srcWidth] = luma[y * stride + m_srcWidth - 1];
+  }
+  if (m_codec->height != m_srcHeight) {
+    std::memcpy(luma + m_srcHeight * stride,
+                luma + (m_srcHeight - 1) * stride,
+                static_cast<size_t>(m_codec->width));
+  }
+}
+
+bool LibavEncoder::encode(AVFrame *frame) {
+  int err = avcodec_send_frame(m_codec, frame);
+  if (err < 0) {
+    std::cerr << "[LibavEncoder] avcodec_send_frame: " << errorText(err)
+              << '\n';
+    return false;
+  }
+  while (true) {
+    err = avcodec_receive_packet(m_codec, m_packet);
+    if (err == AVERROR(EAGAIN) || err == AVERROR_EOF)
+      return true;
+    if (err < 0) {
+      std::cerr << "[LibavEncoder] avcodec_receive_packet: " << errorText(err)
+                << '\n';
+      return false;
+    }
+    av_packet_rescale_ts(m_packet, m_codec->time_base, m_stream->time_base);
+    m_packet->stream_index = m_stream->index;
+    m_bytes += static_cast<size_t>(m_packet->size);
+    err = av_interleaved_write_frame(m_format, m_packet);
+    if (err < 0) {
+      std::cerr << "[LibavEncoder] Falha ao gravar pacote: " << errorText(err)
+                << '\n';
+      return false;
+    }
+  }
+}
+
+bool LibavEncoder::finish(bool aborted) {
+  bool ok = true;
+  if (!aborted) {
+    // Esvazia os frames atrasados (B-frames/lookahead) e fecha o container.
+    ok = encode(nullptr);
+    ok = av_write_trailer(m_format) >= 0 && ok;
+  }
+  release();
+  return ok && !aborted;
+}
+
+void LibavEncoder::release() {
+  sws_freeContext(m_sws);
+  m_sws = nullptr;
+  av_frame_free(&m_frame);
+  av_packet_free(&m_packet);
+  avcodec_free_context(&m_codec);
+  if (m_format) {
+    if (m_format->pb)
+      avio_closep(&m_format->pb);
+    avformat_free_context(m_format);
+    m_format = nullptr;
+  }
+  m_stream = nullptr;
+}
+#endif
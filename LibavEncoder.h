@@ -0,0 +1,47 @@
+#pragma once
+#ifdef HAVE_LIBAV
+#include "VideoEncoder.h"
+#include <atomic>
+
+struct AVCodecContext;
+struct AVFormatContext;
+struct AVFrame;
+struct AVPacket;
+struct AVStream;
+struct SwsContext;
+
+// Encoder H.264 dentro do processo (libavcodec/libavformat/libswscale): os
+// frames vao da memoria para o codec sem processo filho nem pipe, e os bytes
+// gerados sao contados por pacote.
+class LibavEncoder : public VideoEncoder {
+public:
+    explicit LibavEncoder(size_t queueDepth = 4) : VideoEncoder(queueDepth) {}
+    ~LibavEncoder() override;
+
+protected:
+    bool start(const std::string& outputFile, unsigned width, unsigned height,
+               double fps, const std::string& preset) override;
+    bool write(const std::vector<std::uint8_t>& frame) override;
+    bool finish(bool aborted) override;
+    size_t outputBytes() const override { return m_bytes.load(); }
+
+private:
+    // Envia `frame` (nullptr = flush) e grava os pacotes que sairem.
+    bool encode(AVFrame* frame);
+    // Repete a ultima coluna/linha de luma na borda que arredonda o codec
+    // para tamanho par.
+    void padEdges();
+    void release();
+
+    AVFormatContext* m_format = nullptr;
+    AVCodecContext* m_codec = nullptr;
+    AVStream* m_stream = nullptr;
+    AVFrame* m_frame = nullptr;
+    AVPacket* m_packet = nullptr;
+    SwsContext* m_sws = nullptr;
+    int m_srcWidth = 0;   // tamanho dos frames RGBA recebidos; o do codec
+    int m_srcHeight = 0;  // e arredondado para par (exigencia do yuv420p)
+    std::int64_t m_pts = 0;
+    std::atomic<size_t> m_bytes{0};
+};
+#endif
@@ -4,7 +4,15 @@ LinkedListVisualizer::LinkedListVisualizer(sf::Font &font,
                                            const sf::Vector2f &position)
     : m_font(font), m_position(position),
       m_layout(
-          std::make_unique<ListLayoutPolicy>(NODE_WIDTH, PTR_WIDTH, SPACING)) {}
+          std::make_unique<ListLayoutPolicy>(NODE_WIDTH, PTR_WIDTH, SPACING)),
+      m_title("std::list (Linked List)", font, 20), m_headText("head", font, 18),
+      m_nullText("NULL", font, 16), m_valueGlyphs(font, FONT_SIZE),
+      m_valueLabels(sf::Triangles) {
+  m_title.setPosition(m_position.x, m_position.y - 40);
+  m_title.setFillColor(sf::Color::White);
+  m_headText.setFillColor(sf::Color::Yellow);
+  m_nullText.setFillColor(sf::Color::Red);
+}
 
 sf::Vector2f LinkedListVisualizer::getPositionForIndex(size_t i) {
   if (m_layout)
@@ -14,15 +22,6 @@ sf::Vector2f LinkedListVisualizer::getPositionForIndex(size_t i) {
 }
 
 void LinkedListVisualizer::reflow(float windowWidth, float panelWidth) {
-  if (!isIdle())
-    return;
-  bool widthChanged = (windowWidth != m_lastLayoutWidth);
-  bool countChanged = (m_lastNodeCount != m_nodes.size());
-  if (!widthChanged && !countChanged)
-    return;
-  m_lastLayoutWidth = windowWidth;
-  m_lastNodeCount = m_nodes.size();
-
   float margin = 50.f;
   float available =
       std::max(200.f, windowWidth - panelWidth - m_position.x - margin);
@@ -33,15 +32,28 @@ void LinkedListVisualizer::reflow(float windowWidth, float panelWidth) {
   if (maxCols == 1 && available > stride * 0.8f) {
     stride = stride * 0.9f;
   }
-
   float rowHeight = NODE_HEIGHT + 70.f;
-  for (size_t i = 0; i < m_nodes.size(); ++i) {
-    int row = static_cast<int>(i / maxCols);
-    int col = static_cast<int>(i % maxCols);
-    float x = m_position.x + col * stride;
-    float y = m_position.y + row * rowHeight;
-    m_nodes[i].position = {x, y};
-  }
+  GridLayout grid{m_position, static_cast<size_t>(maxCols), stride,
+                  rowHeight};
+  // A grade vale ja durante animacoes: LOD e faixas de valores dependem
+  // dela desde o primeiro frame. So o reposicionamento espera o fim.
+  m_grid = grid;
+  if (!isIdle())
+    return;
+
+  IndexRange range = visibleRange(grid);
+  bool widthChanged = (windowWidth != m_lastLayoutWidth);
+  bool countChanged = (m_lastNodeCount != m_nodes.size());
+  bool rangeChanged = (range != m_lastLayoutRange);
+  if (!widthChanged && !countChanged && !rangeChanged)
+    return;
+  m_lastLayoutWidth = windowWidth;
+  m_lastNodeCount = m_nodes.size();
+  m_lastLayoutRange = range;
+
+  for (size_t i = range.first; i < range.last; ++i)
+    m_nodes[i].position = grid.positionForIndex(i);
+  markDirty();
 }
 
 void LinkedListVisualizer::push_front(int value) {
@@ -126,84 +138,92 @@ void LinkedListVisualizer::buildInsertAtAnimation(int value, size_t index) {
   enqueueAnimation(std::make_unique<ColorStep>(index, sf::Color::Yellow));
 }
 
-void LinkedListVisualizer::draw(sf::RenderWindow &window) const {
-  sf::Text title("std::list (Linked List)", m_font, 20);
-  title.setPosition(m_position.x, m_position.y - 40);
-  title.setFillColor(sf::Color::White);
-  window.draw(title);
-
-  sf::Text headText("head", m_font, 18);
-  headText.setFillColor(sf::Color::Yellow);
-
-  if (!m_nodes.empty()) {
-    sf::FloatRect headBounds = headText.getLocalBounds();
-    headText.setPosition(m_nodes.front().position.x + NODE_WIDTH / 2.f -
-                             headBounds.width / 2.f,
-                         m_nodes.front().position.y - 30.f);
-    window.draw(headText);
+void LinkedListVisualizer::rebuildBatch() const {
+  m_batch.clear();
+  m_valueLabels.clear();
+  if (useValueStrips()) {
+    appendValueStrips(m_batch, NODE_WIDTH + PTR_WIDTH);
+    return;
   }
 
-  for (size_t i = 0; i < m_nodes.size(); ++i) {
+  IndexRange range = drawRange();
+  bool labels = showLabels(NODE_WIDTH);
+  m_batch.reserve((range.last - range.first) * 10,
+                  (range.last - range.first) * 3);
+  const sf::Color dataFill(20, 20, 80);
+  const sf::Color ptrFill(50, 50, 50);
+  const sf::Vector2f nodeSize(NODE_WIDTH + PTR_WIDTH, NODE_HEIGHT);
+
+  // Parado, so a faixa visivel foi reposicionada: o vizinho logo depois
+  // dela pode guardar a posicao de uma grade antiga, entao vem da grade.
+  const bool idle = isIdle();
+  for (size_t i = range.first; i < range.last; ++i) {
     const auto &node = m_nodes[i];
-
-    sf::RectangleShape dataBox(sf::Vector2f(NODE_WIDTH, NODE_HEIGHT));
-    dataBox.setPosition(node.position);
-    dataBox.setFillColor(sf::Color(20, 20, 80));
-    dataBox.setOutlineColor(node.color);
-    dataBox.setOutlineThickness(2.f);
-
-    sf::RectangleShape ptrBox(sf::Vector2f(PTR_WIDTH, NODE_HEIGHT));
-    ptrBox.setPosition(node.position.x + NODE_WIDTH, node.position.y);
-    ptrBox.setFillColor(sf::Color(50, 50, 50));
-    ptrBox.setOutlineColor(node.color);
-    ptrBox.setOutlineThickness(1.f);
-
-    sf::Text valueText(std::to_string(node.value), m_font, FONT_SIZE);
-    valueText.setFillColor(sf::Color::White);
-    sf::FloatRect textBounds = valueText.getLocalBounds();
-    valueText.setOrigin(textBounds.left + textBounds.width / 2.f,
-                        textBounds.top + textBounds.height / 2.f);
-    valueText.setPosition(node.position.x + NODE_WIDTH / 2.f,
-                          node.position.y + NODE_HEIGHT / 2.f);
-
-    window.draw(dataBox);
-    window.draw(ptrBox);
-    window.draw(valueText);
-
-    if (i + 1 < m_nodes.size()) {
-      const auto &next_node = m_nodes[i + 1];
-      bool wrapped = (next_node.position.y != node.position.y);
-      if (!wrapped) {
-        sf::Vertex line[] = {
-            sf::Vertex(
-                sf::Vector2f(node.position.x + NODE_WIDTH + PTR_WIDTH / 2.f,
-                             node.position.y + NODE_HEIGHT / 2.f),
-                sf::Color::Red),
-            sf::Vertex(sf::Vector2f(next_node.position.x,
-                                    next_node.position.y + NODE_HEIGHT / 2.f),
-                       sf::Color::Red)};
-        window.draw(line, 2, sf::Lines);
-      } else {
-        float startX = node.position.x + NODE_WIDTH + PTR_WIDTH / 2.f;
-        float midX = startX + 30.f; // avanço horizontal
-        float midY = next_node.position.y + NODE_HEIGHT / 2.f;
-        sf::Vertex elbow[] = {
-            sf::Vertex(
-                sf::Vector2f(startX, node.position.y + NODE_HEIGHT / 2.f),
-                sf::Color::Red),
-            sf::Vertex(sf::Vector2f(midX, node.position.y + NODE_HEIGHT / 2.f),
-                       sf::Color::Red),
-            sf::Vertex(sf::Vector2f(midX, midY), sf::Color::Red),
-            sf::Vertex(sf::Vector2f(next_node.position.x, midY),
-                       sf::Color::Red)};
-        window.draw(elbow, 4, sf::LineStrip);
-      }
+    bool hasNext = i + 1 < m_nodes.size();
+    const sf::Vector2f next =
+        !hasNext ? sf::Vector2f()
+        : idle   ? m_grid.positionForIndex(i + 1)
+                 : m_nodes[i + 1].position;
+    // A seta ate o proximo no pode cruzar a tela mesmo com o no fora dela.
+    if (!isOnScreen(node.position, nodeSize) &&
+        !(hasNext && isOnScreen(next, nodeSize)))
+      continue;
+    sf::Vector2f ptrPos(node.position.x + NODE_WIDTH, node.position.y);
+
+    m_batch.addRect(node.position, {NODE_WIDTH, NODE_HEIGHT}, dataFill);
+    m_batch.addOutline(node.position, {NODE_WIDTH, NODE_HEIGHT}, 2.f,
+                       node.color);
+    m_batch.addRect(ptrPos, {PTR_WIDTH, NODE_HEIGHT}, ptrFill);
+    m_batch.addOutline(ptrPos, {PTR_WIDTH, NODE_HEIGHT}, 1.f, node.color);
+    if (labels)
+      m_valueGlyphs.appendNumber(m_valueLabels, node.value,
+                                 {node.position.x + NODE_WIDTH / 2.f,
+                                  node.position.y + NODE_HEIGHT / 2.f},
+                                 sf::Color::White);
+
+    if (!hasNext)
+      continue;
+
+    float startX = node.position.x + NODE_WIDTH + PTR_WIDTH / 2.f;
+    float startY = node.position.y + NODE_HEIGHT / 2.f;
+    bool wrapped = (next.y != node.position.y);
+    if (!wrapped) {
+      m_batch.addLine({startX, startY}, {next.x, next.y + NODE_HEIGHT / 2.f},
+                      sf::Color::Red);
     } else {
-      sf::Text nullText("NULL", m_font, 16);
-      nullText.setFillColor(sf::Color::Red);
-      nullText.setPosition(node.position.x + NODE_WIDTH + PTR_WIDTH + 5,
-                           node.position.y + NODE_HEIGHT / 3.f);
-      window.draw(nullText);
+      float midX = startX + 30.f; // avanço horizontal
+      float midY = next.y + NODE_HEIGHT / 2.f;
+      m_batch.addLine({startX, startY}, {midX, startY}, sf::Color::Red);
+      m_batch.addLine({midX, startY}, {midX, midY}, sf::Color::Red);
+      m_batch.addLine({midX, midY}, {next.x, midY}, sf::Color::Red);
     }
   }
 }
+
+void LinkedListVisualizer::draw(sf::RenderTarget &target) const {
+  target.draw(m_title);
+
+  if (m_dirty) {
+    rebuildBatch();
+    m_dirty = false;
+  }
+
+  bool detailed = !useValueStrips() && showLabels(NODE_WIDTH);
+  if (detailed && !m_nodes.empty()) {
+    sf::FloatRect headBounds = m_headText.getLocalBounds();
+    m_headText.setPosition(m_nodes.front().position.x + NODE_WIDTH / 2.f -
+                               headBounds.width / 2.f,
+                           m_nodes.front().position.y - 30.f);
+    target.draw(m_headText);
+  }
+
+  m_batch.draw(target);
+  target.draw(m_valueLabels, sf::RenderStates(&m_valueGlyphs.texture()));
+
+  if (detailed && !m_nodes.empty()) {
+    const auto &last = m_nodes.back();
+    m_nullText.setPosition(last.position.x + NODE_WIDTH + PTR_WIDTH + 5,
+                           last.position.y + NODE_HEIGHT / 3.f);
+    target.draw(m_nullText);
+  }
+}
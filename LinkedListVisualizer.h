@@ -1,6 +1,8 @@
 #pragma once
 #include "Visualizer.h"
 #include "LayoutPolicy.h"
+#include "GlyphAtlas.h"
+#include "ShapeBatch.h"
 
 class LinkedListVisualizer final : public Visualizer {
 public:
@@ -11,7 +13,7 @@ public:
     void insertAt(int value, size_t index);
     void clearAnimated();
     
-    void draw(sf::RenderWindow& window) const override;
+    void draw(sf::RenderTarget& target) const override;
     void reflow(float windowWidth, float panelWidth = 280.f);
 
 private:
@@ -20,6 +22,7 @@ private:
     void buildInsertAtAnimation(int value, size_t index);
 
     sf::Vector2f getPositionForIndex(size_t i);
+    void rebuildBatch() const;
 
     sf::Font& m_font;
     sf::Vector2f m_position;
@@ -32,4 +35,12 @@ private:
     static constexpr int FONT_SIZE = 22;
     float m_lastLayoutWidth = 0.f;
     size_t m_lastNodeCount = 0;
+    IndexRange m_lastLayoutRange;
+
+    sf::Text m_title;
+    mutable sf::Text m_headText;
+    mutable sf::Text m_nullText;
+    mutable ShapeBatch m_batch;
+    mutable GlyphAtlas m_valueGlyphs;
+    mutable sf::VertexArray m_valueLabels;
 };
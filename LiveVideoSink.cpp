@@ -0,0 +1,37 @@
+#include "LiveVideoSink.h"
+#include <iostream>
+
+bool LiveVideoSink::start(const std::string &file, unsigned width,
+                          unsigned height, double fps,
+                          const std::string &preset) {
+  m_skipped = 0;
+  m_failed = false;
+  return m_encoder->open(file, width, height, fps, preset);
+}
+
+bool LiveVideoSink::stop() {
+  if (!m_encoder->isOpen())
+    return false;
+  bool ok = m_encoder->close();
+  std::cout << "[LiveVideoSink] " << m_encoder->framesWritten()
+            << " frames gravados, " << m_skipped
+            << " ignorados (tamanho diferente)" << '\n';
+  return ok;
+}
+
+void LiveVideoSink::accept(const FrameView &view, const sf::IntRect &region) {
+  if (!m_encoder->isOpen() || m_failed)
+    return;
+  m_frame.pixels = m_encoder->acquire();
+  copyRegion(view, region.left, region.top, region.width, region.height,
+             m_frame);
+  // Janela redimensionada durante a gravacao: o ffmpeg espera o tamanho
+  // do inicio.
+  if (m_frame.bytes() != m_encoder->frameBytes()) {
+    ++m_skipped;
+    m_encoder->release(std::move(m_frame.pixels));
+    return;
+  }
+  if (!m_encoder->submit(std::move(m_frame.pixels)))
+    m_failed = true;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "FrameSink.h"
+#include "VideoEncoder.h"
+#include <memory>
+#include <string>
+
+// Grava o que o CaptureService le direto no encoder, sem passar pela memoria
+// de frames nem por PNG. Se o ffmpeg atrasar, accept() bloqueia na fila do
+// encoder (backpressure) em vez de acumular frames.
+class LiveVideoSink : public FrameSink {
+public:
+    explicit LiveVideoSink(size_t queueDepth = 8)
+        : m_encoder(VideoEncoder::create(queueDepth)) {}
+
+    // Tamanho fixo: deve bater com a regiao inscrita no CaptureService.
+    bool start(const std::string& file, unsigned width, unsigned height, double fps,
+               const std::string& preset = "ultrafast");
+    bool stop();
+
+    bool capturing() const override { return m_encoder->isOpen(); }
+    void accept(const FrameView& view, const sf::IntRect& region) override;
+
+    size_t framesWritten() const { return m_encoder->framesWritten(); }
+    size_t framesSkipped() const { return m_skipped; }
+    // O encoder recusou um frame (ffmpeg morreu, disco cheio...).
+    bool failed() const { return m_failed; }
+
+private:
+    std::unique_ptr<VideoEncoder> m_encoder;
+    RawFrame m_frame;
+    size_t m_skipped = 0;
+    bool m_failed = false;
+};
@@ -0,0 +1,46 @@
+#include "MappedFile.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool MappedFile::open(const std::string &path, bool sequential) {
+  close();
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    ::close(fd);
+    return false;
+  }
+  m_size = static_cast<size_t>(st.st_size);
+  if (m_size > 0) {
+    void *base = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (base == MAP_FAILED) {
+      std::cerr << "[MappedFile] mmap de " << path
+                << " falhou: " << std::strerror(errno) << '\n';
+      ::close(fd);
+      m_size = 0;
+      return false;
+    }
+    m_base = static_cast<std::uint8_t *>(base);
+    if (sequential)
+      madvise(base, m_size, MADV_SEQUENTIAL);
+  }
+  // O mapeamento continua valido depois de fechar o descritor.
+  ::close(fd);
+  m_open = true;
+  return true;
+}
+
+void MappedFile::close() {
+  if (m_base)
+    munmap(m_base, m_size);
+  m_base = nullptr;
+  m_size = 0;
+  m_open = false;
+}
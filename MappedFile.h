@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Arquivo inteiro mapeado so para leitura. Abrir nao le nada: as paginas
+// vem do page cache sob demanda. Arquivo vazio abre com size() == 0.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // sequential: avisa o kernel para ler adiante (parsers de uma passada).
+    bool open(const std::string& path, bool sequential = false);
+    void close();
+    bool isOpen() const { return m_open; }
+
+    const std::uint8_t* data() const { return m_base; }
+    size_t size() const { return m_size; }
+
+private:
+    std::uint8_t* m_base = nullptr;
+    size_t m_size = 0;
+    bool m_open = false;
+};
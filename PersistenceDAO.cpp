@@ -1,25 +1,161 @@
 #include "PersistenceDAO.h"
-#include <SFML/Graphics.hpp>
+#include "AnimationWriter.h"
+#include "VideoEncoder.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
 #include <signal.h>
 #include <sstream>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <thread>
 #include <unistd.h>
 #include <vector>
 
 namespace fs = std::filesystem;
 
+namespace {
+std::mutex g_dirMutex;
+std::condition_variable g_dirFreed;
+std::set<std::string> g_busyDirs;
+} // namespace
+
+PersistenceDAO::DirectoryLock::DirectoryLock(
+    const std::string &dirPath, const std::function<bool()> &shouldCancel) {
+  // Mesmo diretorio escrito de formas diferentes ("d", "./d/") da a mesma
+  // chave.
+  std::error_code ec;
+  fs::path key = fs::weakly_canonical(fs::absolute(dirPath, ec), ec);
+  if (ec)
+    key = fs::path(dirPath);
+  key = key.lexically_normal();
+  if (!key.has_filename() && key.has_parent_path())
+    key = key.parent_path();
+  m_key = key.string();
+  std::unique_lock<std::mutex> lk(g_dirMutex);
+  bool announced = false;
+  while (g_busyDirs.count(m_key)) {
+    if (shouldCancel && shouldCancel())
+      return;
+    if (!announced) {
+      std::cout << "[PersistenceDAO] Esperando outro export em " << dirPath
+                << '\n';
+      announced = true;
+    }
+    // Acorda de tempos em tempos para ver o cancelamento.
+    g_dirFreed.wait_for(lk, std::chrono::milliseconds(100));
+  }
+  g_busyDirs.insert(m_key);
+  m_held = true;
+}
+
+PersistenceDAO::DirectoryLock::~DirectoryLock() {
+  if (!m_held)
+    return;
+  {
+    std::lock_guard<std::mutex> lk(g_dirMutex);
+    g_busyDirs.erase(m_key);
+  }
+  g_dirFreed.notify_all();
+}
+
+std::uint64_t PersistenceDAO::hashFrame(const RawFrame &frame) {
+  // Mistura de 8 em 8 bytes; so precisa distinguir frames, nao resistir a
+  // colisoes provocadas.
+  std::uint64_t h = 0x9E3779B97F4A7C15ull ^ frame.width ^
+                    (static_cast<std::uint64_t>(frame.height) << 32);
+  const std::uint8_t *p = frame.pixels.data();
+  const size_t n = frame.pixels.size();
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    std::uint64_t w;
+    std::memcpy(&w, p + i, 8);
+    h = (h ^ w) * 0xFF51AFD7ED558CCDull;
+    h ^= h >> 32;
+  }
+  for (; i < n; ++i)
+    h = (h ^ p[i]) * 0x100000001B3ull;
+  return h;
+}
+
+bool PersistenceDAO::loadManifest(const std::string &dirPath,
+                                  const std::string &prefix,
+                                  const std::string &ext, unsigned width,
+                                  unsigned height, std::uint64_t &generation,
+                                  std::vector<ManifestEntry> &out) {
+  out.clear();
+  generation = 0;
+  std::ifstream in(fs::path(dirPath) / (prefix + "_manifest.txt"));
+  std::string magic, fileExt;
+  int version = 0;
+  unsigned w = 0, h = 0;
+  // Versao 1 nao tinha geracao: nao da para saber de que sessao sao os ids.
+  if (!(in >> magic >> version >> fileExt >> w >> h >> std::hex >>
+        generation >> std::dec) ||
+      magic != "manifest" || version != 2 || fileExt != ext || w != width ||
+      h != height)
+    return false;
+  ManifestEntry e;
+  while (in >> e.id >> std::hex >> e.hash >> std::dec >> e.fileIndex >>
+         e.repeat >> e.file) {
+    // So arquivos que ainda existem; um buraco invalida o resto.
+    if (!fs::exists(fs::path(dirPath) / e.file))
+      break;
+    out.push_back(e);
+  }
+  return !out.empty();
+}
+
+bool PersistenceDAO::writeManifest(const std::string &dirPath,
+                                   const std::string &prefix,
+                                   const std::string &ext, unsigned width,
+                                   unsigned height, std::uint64_t generation,
+                                   const std::vector<ManifestEntry> &entries) {
+  const fs::path path = fs::path(dirPath) / (prefix + "_manifest.txt");
+  const fs::path tmp = path.string() + ".tmp";
+  {
+    std::ofstream out(tmp);
+    out << "manifest 2 " << ext << ' ' << width << ' ' << height << ' '
+        << std::hex << generation << std::dec << '\n';
+    for (const ManifestEntry &e : entries)
+      out << e.id << ' ' << std::hex << e.hash << std::dec << ' '
+          << e.fileIndex << ' ' << e.repeat << ' ' << e.file << '\n';
+    if (!out)
+      return false;
+  }
+  std::error_code ec;
+  fs::rename(tmp, path, ec);
+  return !ec;
+}
+
 bool PersistenceDAO::saveFrames(
-    const std::vector<sf::Image> &frames, const std::string &dirPath,
+    const FrameSource &frames, const std::string &dirPath,
     const std::string &prefix, int startIndex,
     const std::function<void(size_t, size_t)> &onProgress,
-    const std::function<bool()> &shouldCancel) const {
-  if (frames.empty()) {
+    const std::function<bool()> &shouldCancel,
+    const WriteStatsFn &onWriteStats) const {
+  const size_t count = frames.frameCount();
+  RawFrame probe;
+  if (count == 0 || !frames.readFrame(0, probe)) {
     std::cerr << "[PersistenceDAO] Nenhum frame para salvar." << '\n';
     return false;
   }
+  const DirectoryLock dirLock(dirPath, shouldCancel);
+  if (!dirLock.held()) {
+    std::cout << "[PersistenceDAO] Cancelado salvamento de frames." << '\n';
+    return false;
+  }
   std::error_code ec;
   fs::create_directories(dirPath, ec);
   if (ec) {
@@ -27,40 +163,300 @@ bool PersistenceDAO::saveFrames(
               << " -> " << ec.message() << '\n';
     return false;
   }
+  // Decodifica em ordem nesta thread (o store le sequencialmente) e codifica
+  // os arquivos em paralelo; no maximo 2 frames por worker ficam em memoria.
+  const std::unique_ptr<FrameWriter> writer = FrameWriter::create(m_frameFormat);
+  const std::string ext = writer->extension();
+  const unsigned width = probe.width, height = probe.height;
+  // Formatos sem cabecalho nao passam pelo concat demuxer: repeticoes viram
+  // hard links numerados em sequencia, sem reescrever os pixels.
+  const bool expandRepeats = !writer->selfDescribing();
+
+  auto fileName = [&](size_t fileIndex) {
+    std::ostringstream fname;
+    fname << prefix << '_' << std::setw(4) << std::setfill('0') << fileIndex
+          << '.' << ext;
+    return fname.str();
+  };
+  auto linkRepeats = [&](size_t first, size_t from, size_t to) {
+    const fs::path src = fs::path(dirPath) / fileName(first);
+    for (size_t k = from; k < to; ++k) {
+      const fs::path dst = fs::path(dirPath) / fileName(first + k);
+      fs::remove(dst, ec);
+      fs::create_hard_link(src, dst, ec);
+      if (ec)
+        fs::copy_file(src, dst, ec);
+    }
+  };
+
+  // Retoma so na mesma sessao de captura (geracao da fonte), depois do
+  // ultimo frame do manifesto se ele ainda e o mesmo frame desta fonte (id e
+  // hash). Na mesma geracao os ids so somem da frente por descarte do modo
+  // circular: ids anteriores a fonte sairam da memoria antes do export e o
+  // que restou e anexado. Outra geracao (clear, outro processo) regrava.
+  const std::uint64_t generation = frames.generation();
+  std::uint64_t manifestGeneration = 0;
+  std::vector<ManifestEntry> manifest;
+  size_t begin = 0;
+  bool resumed = false;
+  if (loadManifest(dirPath, prefix, ext, width, height, manifestGeneration,
+                   manifest) &&
+      generation != 0 && manifestGeneration == generation) {
+    ManifestEntry &last = manifest.back();
+    const size_t firstId = frames.frameId(0);
+    const size_t index = last.id - firstId;
+    RawFrame check;
+    if (last.id < firstId) {
+      if (last.id + 1 < firstId)
+        std::cout << "[PersistenceDAO] " << firstId - last.id - 1
+                  << " frames sairam da memoria desde o ultimo export de "
+                  << dirPath << "; anexando o restante." << '\n';
+      resumed = true;
+    } else if (index < count && frames.frameId(index) == last.id &&
+               frames.readFrame(index, check) &&
+               hashFrame(check) == last.hash) {
+      // O ultimo frame pode ter ganho repeticoes desde o export anterior.
+      const size_t repeat = frames.frameRepeat(index);
+      if (repeat > last.repeat) {
+        if (expandRepeats)
+          linkRepeats(last.fileIndex, last.repeat, repeat);
+        last.repeat = repeat;
+      }
+      begin = index + 1;
+      resumed = true;
+    }
+  }
+  if (!resumed) {
+    if (!manifest.empty())
+      std::cout << "[PersistenceDAO] Manifesto de " << dirPath
+                << " nao confere com os frames; regravando tudo." << '\n';
+    manifest.clear();
+    clearTempFiles(dirPath, prefix);
+  }
+  size_t fileIndex =
+      manifest.empty()
+          ? static_cast<size_t>(std::max(startIndex, 0))
+          : manifest.back().fileIndex +
+                (expandRepeats ? manifest.back().repeat : 1);
+
+  const size_t total = count - begin; // frames novos
+  const size_t slotCount = WorkerPool::defaultThreads() * 2;
+  std::vector<RawFrame> slots(slotCount);
+  std::vector<size_t> freeSlots;
+  for (size_t s = 0; s < slotCount; ++s)
+    freeSlots.push_back(s);
+  std::vector<ManifestEntry> added(total);
+  std::vector<char> done(total, 0);
+  std::vector<char> saved(total, 0);
+  std::mutex mtx;
+  std::condition_variable cv;
   bool ok = true;
-  int idx = startIndex;
-  size_t total = frames.size();
-  size_t current = 0;
-  for (const auto &img : frames) {
+  size_t current = 0; // frames concluidos em ordem (progresso)
+
+  // Workers codificam; a gravacao vai em lotes para a fila de I/O, que
+  // escreve enquanto os proximos frames ainda estao sendo codificados. A
+  // fila tem a mesma profundidade dos slots para limitar a memoria.
+  const std::unique_ptr<AsyncFileWriter> io =
+      AsyncFileWriter::create(slotCount);
+
+  // Progresso so avanca sobre o prefixo contiguo de frames prontos.
+  auto reportOrdered = [&](std::unique_lock<std::mutex> &lk) {
+    size_t before = current;
+    while (current < total && done[current])
+      ++current;
+    if (current != before && (onProgress || onWriteStats)) {
+      lk.unlock();
+      if (onWriteStats)
+        onWriteStats(io->stats());
+      if (onProgress)
+        for (size_t c = before + 1; c <= current; ++c)
+          onProgress(c, total);
+      lk.lock();
+    }
+  };
+
+  size_t submitted = 0;
+  WorkerPool pool;
+  for (size_t k = 0; k < total; ++k) {
     if (shouldCancel && shouldCancel()) {
       std::cout << "[PersistenceDAO] Cancelado salvamento de frames." << '\n';
+      // O que ja foi gravado entra no manifesto, mas o diretorio esta
+      // incompleto: quem chama (Shift+M) nao pode seguir para o video.
+      ok = false;
       break;
     }
-    std::ostringstream fname;
-    fname << prefix << '_' << std::setw(4) << std::setfill('0') << idx++
-          << ".png";
-    auto filePath = (fs::path(dirPath) / fname.str()).string();
-    if (!img.saveToFile(filePath)) {
-      std::cerr << "[PersistenceDAO] Falha ao salvar " << filePath << '\n';
-      ok = false; // continua salvando os demais
-    }
-    ++current;
-    if (onProgress)
-      onProgress(current, total);
+    size_t slot;
+    {
+      std::unique_lock<std::mutex> lk(mtx);
+      cv.wait(lk, [&] { return !freeSlots.empty(); });
+      reportOrdered(lk);
+      slot = freeSlots.back();
+      freeSlots.pop_back();
+    }
+    const size_t i = begin + k;
+    if (!frames.readFrame(i, slots[slot]) || slots[slot].width != width ||
+        slots[slot].height != height) {
+      std::lock_guard<std::mutex> lk(mtx);
+      freeSlots.push_back(slot);
+      ok = false;
+      break;
+    }
+    ManifestEntry &entry = added[k];
+    entry.id = frames.frameId(i);
+    entry.fileIndex = fileIndex;
+    entry.repeat = frames.frameRepeat(i);
+    entry.file = fileName(fileIndex);
+    fileIndex += expandRepeats ? entry.repeat : 1;
+    ++submitted;
+    pool.submit([&, k, slot] {
+      ManifestEntry &e = added[k];
+      e.hash = hashFrame(slots[slot]);
+      auto filePath = (fs::path(dirPath) / e.file).string();
+      auto finish = [&, k, filePath](bool wrote) {
+        if (!wrote)
+          std::cerr << "[PersistenceDAO] Falha ao salvar " << filePath << '\n';
+        std::lock_guard<std::mutex> lk(mtx);
+        if (!wrote)
+          ok = false; // continua salvando os demais
+        saved[k] = wrote;
+        done[k] = 1;
+        cv.notify_all();
+      };
+      auto releaseSlot = [&, slot] {
+        std::lock_guard<std::mutex> lk(mtx);
+        freeSlots.push_back(slot);
+        cv.notify_all();
+      };
+      std::vector<std::uint8_t> encoded;
+      if (!writer->encode(slots[slot], encoded)) {
+        // Formato que so grava direto no arquivo (PNG sem libpng).
+        const bool wrote = writer->write(slots[slot], filePath);
+        releaseSlot();
+        finish(wrote);
+        return;
+      }
+      // O slot volta antes da gravacao: a leitura do proximo frame segue
+      // enquanto este espera a fila de I/O.
+      releaseSlot();
+      io->write(std::move(filePath), std::move(encoded), finish);
+    });
+  }
+  pool.waitIdle();
+  io->flush(); // falhas ja marcadas por arquivo em `finish`
+  {
+    std::unique_lock<std::mutex> lk(mtx);
+    reportOrdered(lk);
+  }
+  // O manifesto so cresce pelo prefixo gravado sem falhas, para continuar
+  // daqui no proximo export.
+  size_t persisted = 0;
+  while (persisted < submitted && saved[persisted])
+    ++persisted;
+  for (size_t k = 0; k < persisted; ++k) {
+    if (expandRepeats && added[k].repeat > 1)
+      linkRepeats(added[k].fileIndex, 1, added[k].repeat);
+    manifest.push_back(std::move(added[k]));
+  }
+  if (!writeManifest(dirPath, prefix, ext, width, height, generation,
+                     manifest))
+    std::cerr << "[PersistenceDAO] Falha ao gravar manifesto em " << dirPath
+              << '\n';
+  // exportMP4 le daqui a extensao e, para raw, o tamanho do frame.
+  {
+    std::ofstream info(fs::path(dirPath) / (prefix + "_format.txt"));
+    info << ext << ' ' << width << ' ' << height << '\n';
+  }
+
+  // Frames repetidos viram duracao: exportMP4 monta uma lista do concat
+  // demuxer a partir deste arquivo em vez de duplicar PNGs.
+  size_t captures = 0;
+  std::ostringstream runs;
+  for (const ManifestEntry &e : manifest) {
+    runs << e.file << ' ' << e.repeat << '\n';
+    captures += e.repeat;
   }
-  std::cout << "[PersistenceDAO] " << (ok ? "Todos" : "Alguns")
-            << " frames salvos em " << dirPath << '\n';
+  auto runsPath = fs::path(dirPath) / (prefix + "_runs.txt");
+  if (captures > manifest.size() && !expandRepeats) {
+    std::ofstream out(runsPath);
+    out << runs.str();
+  } else {
+    fs::remove(runsPath, ec);
+  }
+  char rate[32];
+  std::snprintf(rate, sizeof(rate), "%.1f",
+                io->stats().bytesPerSecond() / 1048576.0);
+  std::cout << "[PersistenceDAO] " << (ok ? "Todos" : "Alguns") << " frames ("
+            << persisted << " novos, " << manifest.size() << " unicos de "
+            << captures << " capturas no total) salvos em " << dirPath << " ("
+            << io->backend() << ", " << rate << " MB/s)" << '\n';
   return ok;
 }
 
+std::vector<std::string>
+PersistenceDAO::inputArgs(const std::string &framesDir, int fps,
+                          const std::string &prefix) const {
+  const fs::path dir(framesDir);
+  std::string ext = "png";
+  unsigned width = 0, height = 0;
+  {
+    std::ifstream info(dir / (prefix + "_format.txt"));
+    if (info)
+      info >> ext >> width >> height;
+  }
+  const std::string pattern = (dir / (prefix + "_%04d." + ext)).string();
+  if (ext == "rgba") {
+    const std::string size =
+        std::to_string(width) + 'x' + std::to_string(height);
+    return {"-f",    "image2",   "-framerate",    std::to_string(fps),
+            "-c:v",  "rawvideo", "-pixel_format", "rgba",
+            "-video_size", size, "-i",            pattern};
+  }
+  std::ifstream runs(dir / (prefix + "_runs.txt"));
+  if (!runs)
+    return {"-framerate", std::to_string(fps), "-i", pattern};
+  // Cada arquivo dura (repeticoes / fps); o ultimo e repetido porque o
+  // concat demuxer ignora a duracao da ultima entrada.
+  const fs::path listPath = dir / (prefix + "_concat.txt");
+  std::ofstream list(listPath);
+  list << "ffconcat version 1.0\n";
+  std::string name, last;
+  size_t repeat = 0;
+  while (runs >> name >> repeat) {
+    list << "file '" << name << "'\nduration "
+         << static_cast<double>(repeat) / fps << '\n';
+    last = name;
+  }
+  if (!last.empty())
+    list << "file '" << last << "'\n";
+  return {"-f", "concat", "-safe", "0", "-i", listPath.string(),
+          "-fps_mode", "vfr"};
+}
+
+std::string PersistenceDAO::shellJoin(const std::vector<std::string> &args) {
+  std::ostringstream cmd;
+  for (size_t i = 0; i < args.size(); ++i) {
+    if (i)
+      cmd << ' ';
+    if (args[i].find_first_of(" %'\"()*") != std::string::npos)
+      cmd << '"' << args[i] << '"';
+    else
+      cmd << args[i];
+  }
+  return cmd.str();
+}
+
 bool PersistenceDAO::exportMP4(const std::string &framesDir,
                                const std::string &outputFile, int fps) const {
-  fs::path pattern = fs::path(framesDir) / "frame_%04d.png";
-  std::ostringstream cmd;
-  cmd << "ffmpeg -y -framerate " << fps << " -i " << '"' << pattern.string()
-      << '"' << " -c:v libx264 -pix_fmt yuv420p " << '"' << outputFile << '"';
-  std::cout << "[PersistenceDAO] Executando: " << cmd.str() << '\n';
-  int code = std::system(cmd.str().c_str());
+  std::vector<std::string> args = {"ffmpeg", "-y"};
+  for (auto &a : inputArgs(framesDir, fps))
+    args.push_back(a);
+  for (const char *a : {"-vf", VideoEncoder::EVEN_SIZE_FILTER, "-c:v",
+                        "libx264", "-pix_fmt", "yuv420p"})
+    args.push_back(a);
+  args.push_back(outputFile);
+  std::string cmd = shellJoin(args);
+  std::cout << "[PersistenceDAO] Executando: " << cmd << '\n';
+  int code = std::system(cmd.c_str());
   if (code != 0) {
     std::cerr << "[PersistenceDAO] ffmpeg retornou código " << code << '\n';
     return false;
@@ -72,15 +468,17 @@ bool PersistenceDAO::exportMP4(const std::string &framesDir,
 bool PersistenceDAO::exportMP4WithProgress(
     const std::string &framesDir, const std::string &outputFile, int fps,
     const std::function<void(const std::string &)> &onProgress) const {
-  namespace fs = std::filesystem;
-  fs::path pattern = fs::path(framesDir) / "frame_%04d.png";
-  std::ostringstream cmd;
-
-  cmd << "ffmpeg -y -hide_banner -loglevel error -progress pipe:1 -framerate "
-      << fps << " -i " << '"' << pattern.string() << '"'
-      << " -c:v libx264 -pix_fmt yuv420p " << '"' << outputFile << '"';
+  std::vector<std::string> args = {"ffmpeg",    "-y",        "-hide_banner",
+                                   "-loglevel", "error",     "-progress",
+                                   "pipe:1"};
+  for (auto &a : inputArgs(framesDir, fps))
+    args.push_back(a);
+  for (const char *a : {"-vf", VideoEncoder::EVEN_SIZE_FILTER, "-c:v",
+                        "libx264", "-pix_fmt", "yuv420p"})
+    args.push_back(a);
+  args.push_back(outputFile);
 
-  std::string full = cmd.str();
+  std::string full = shellJoin(args);
   std::cout << "[PersistenceDAO] Executando (progress): " << full << '\n';
   FILE *pipe = popen(full.c_str(), "r");
 
@@ -123,29 +521,37 @@ bool PersistenceDAO::exportMP4WithProgressCancelable(
     pid_t &outPid,
     const std::function<void(const std::string &)> &onProgress) const {
 
-  namespace fs = std::filesystem;
-  fs::path pattern = fs::path(framesDir) / "frame_%04d.png";
-
-  std::vector<std::string> args = {"ffmpeg",
-                                   "-y",
-                                   "-hide_banner",
-                                   "-loglevel",
-                                   "error",
-                                   "-progress",
-                                   "pipe:1",
-                                   "-framerate",
-                                   std::to_string(fps),
-                                   "-i",
-                                   pattern.string(),
-                                   "-c:v",
-                                   "libx264",
-                                   "-pix_fmt",
-                                   "yuv420p",
-                                   outputFile};
+  std::vector<std::string> args = {"ffmpeg",    "-y",        "-hide_banner",
+                                   "-loglevel", "error",     "-progress",
+                                   "pipe:1"};
+  for (auto &a : inputArgs(framesDir, fps))
+    args.push_back(a);
+  for (const char *a : {"-vf", VideoEncoder::EVEN_SIZE_FILTER, "-c:v",
+                        "libx264", "-pix_fmt", "yuv420p"})
+    args.push_back(a);
+  args.push_back(outputFile);
+
+  const bool ok = runProcess(
+      args,
+      [&outPid](pid_t pid) {
+        if (pid > 0)
+          outPid = pid;
+      },
+      onProgress);
+  if (onProgress)
+    onProgress("progress=end");
+  return ok;
+}
 
+bool PersistenceDAO::runProcess(
+    const std::vector<std::string> &args,
+    const std::function<void(pid_t)> &onPid,
+    const std::function<void(const std::string &)> &onLine) {
   int pipefd[2];
 
-  if (pipe(pipefd) != 0) {
+  // CLOEXEC: trechos rodam ffmpegs em paralelo, e um filho que herdasse a
+  // ponta de escrita do irmao seguraria o EOF dele ate terminar.
+  if (pipe2(pipefd, O_CLOEXEC) != 0) {
 
     std::cerr << "[PersistenceDAO] Falha pipe." << std::endl;
     return false;
@@ -155,11 +561,14 @@ bool PersistenceDAO::exportMP4WithProgressCancelable(
 
   if (pid < 0) {
     std::cerr << "[PersistenceDAO] fork falhou." << std::endl;
+    close(pipefd[0]);
+    close(pipefd[1]);
     return false;
   }
 
   if (pid == 0) {
-    close(pipefd[0]);
+    // As copias do dup2 nao herdam CLOEXEC; as pontas originais fecham no
+    // exec.
     dup2(pipefd[1], STDOUT_FILENO);
     dup2(pipefd[1], STDERR_FILENO);
     std::vector<char *> cargs;
@@ -169,16 +578,22 @@ bool PersistenceDAO::exportMP4WithProgressCancelable(
       cargs.push_back(const_cast<char *>(a.c_str()));
 
     cargs.push_back(nullptr);
-    execvp("ffmpeg", cargs.data());
+    execvp(cargs[0], cargs.data());
     _exit(127);
   }
 
-  outPid = pid;
+  if (onPid)
+    onPid(pid);
   close(pipefd[1]);
   FILE *stream = fdopen(pipefd[0], "r");
 
   if (!stream) {
     std::cerr << "[PersistenceDAO] fdopen falhou." << std::endl;
+    close(pipefd[0]);
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+    if (onPid)
+      onPid(0);
     return false;
   }
 
@@ -197,18 +612,435 @@ bool PersistenceDAO::exportMP4WithProgressCancelable(
     while (!line.empty() && (line.back() == '\n' || line.back() == '\r'))
       line.pop_back();
 
-    if (!line.empty() && onProgress)
-      onProgress(line);
+    if (!line.empty() && onLine)
+      onLine(line);
   }
 
   fclose(stream);
+  if (onPid)
+    onPid(0);
   int status = 0;
   waitpid(pid, &status, 0);
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
 
-  if (onProgress)
-    onProgress("progress=end");
+bool PersistenceDAO::exportMP4Segmented(
+    const std::string &framesDir, const std::string &outputFile, int fps,
+    size_t segments, const std::function<void(size_t, size_t)> &onProgress,
+    const std::function<bool()> &shouldCancel,
+    const std::string &prefix) const {
+  // Le o manifesto e grava os trechos no diretorio: nao pode cruzar com um
+  // saveFrames no mesmo diretorio.
+  const DirectoryLock dirLock(framesDir, shouldCancel);
+  if (!dirLock.held())
+    return false;
+  const fs::path dir(framesDir);
+  std::string ext = "png";
+  unsigned width = 0, height = 0;
+  {
+    std::ifstream info(dir / (prefix + "_format.txt"));
+    if (info)
+      info >> ext >> width >> height;
+  }
+  // Nomes dos arquivos numerados, como saveFrames grava.
+  auto frameName = [&](size_t fileIndex) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "_%04zu.", fileIndex);
+    return prefix + name + ext;
+  };
+  // Arquivos na ordem, quantos ticks cada um dura e o hash do conteudo
+  // (0 = desconhecido, sem manifesto: trechos nao sao reaproveitados).
+  struct Entry {
+    std::string name;
+    size_t repeat = 1;
+    std::uint64_t hash = 0;
+  };
+  std::vector<Entry> entries;
+  std::vector<ManifestEntry> manifest;
+  std::uint64_t generation = 0; // so importa para saveFrames
+  if (loadManifest(framesDir, prefix, ext, width, height, generation,
+                   manifest)) {
+    for (const ManifestEntry &m : manifest) {
+      if (ext != "rgba") {
+        entries.push_back({m.file, m.repeat, m.hash});
+        continue;
+      }
+      // raw: cada repeticao e um arquivo (hard link) de 1 tick.
+      for (size_t r = 0; r < m.repeat; ++r)
+        entries.push_back({frameName(m.fileIndex + r), 1, m.hash});
+    }
+  } else {
+    std::ifstream runs(dir / (prefix + "_runs.txt"));
+    if (runs && ext != "rgba") {
+      Entry e;
+      while (runs >> e.name >> e.repeat)
+        entries.push_back(e);
+    } else {
+      for (size_t i = 0; fs::exists(dir / frameName(i)); ++i)
+        entries.push_back({frameName(i), 1});
+    }
+  }
+  if (entries.empty() || fps <= 0) {
+    std::cerr << "[PersistenceDAO] Nenhum frame em " << framesDir << '\n';
+    return false;
+  }
 
-  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  // Cada ffmpeg ja usa varias threads no x264; divide os nucleos pela
+  // divisao pedida, e nao pelo que sobrou a codificar, para que os mesmos
+  // parametros gerem a mesma chave de um export para o outro.
+  const size_t cores = WorkerPool::defaultThreads();
+  const std::string threads = std::to_string(
+      std::max<size_t>(1, cores / (segments ? segments : cores)));
+  // Mesmos parametros em todos os trechos, para o concat sem recodificar.
+  const std::vector<std::string> encoderArgs = {
+      "-vf",      VideoEncoder::EVEN_SIZE_FILTER,
+      "-c:v",     "libx264",
+      "-preset",  "veryfast",
+      "-threads", threads,
+      "-pix_fmt", "yuv420p"};
+
+  // Chave de um trecho: conteudo, duracoes e parametros de codificacao.
+  const bool cacheable = !manifest.empty();
+  auto segmentKey = [&](size_t first, size_t last) {
+    std::uint64_t h = 0xCBF29CE484222325ull ^ static_cast<std::uint64_t>(fps);
+    for (const std::string &a : encoderArgs) {
+      for (const char c : a)
+        h = (h ^ static_cast<unsigned char>(c)) * 0x100000001B3ull;
+      h = (h ^ 0xFF) * 0x100000001B3ull; // separador
+    }
+    for (size_t i = first; i < last; ++i)
+      h = ((h ^ entries[i].hash) * 0x100000001B3ull ^ entries[i].repeat) *
+          0xFF51AFD7ED558CCDull;
+    char key[17];
+    std::snprintf(key, sizeof(key), "%016llx",
+                  static_cast<unsigned long long>(h));
+    return std::string(key);
+  };
+  // <prefix>_segment_<primeiro>_<fim>_<chave>.mp4 ja codificados no
+  // diretorio; outros prefixos no mesmo diretorio tem os seus.
+  struct Cached {
+    size_t last;
+    std::string key;
+    fs::path file;
+  };
+  std::multimap<size_t, Cached> cached;
+  std::vector<fs::path> oldSegments;
+  std::error_code ec;
+  const std::string segmentPrefix = prefix + "_segment_";
+  for (const auto &file : fs::directory_iterator(dir, ec)) {
+    const std::string fname = file.path().filename().string();
+    unsigned long long first = 0, last = 0;
+    char key[17] = {0};
+    if (fname.compare(0, segmentPrefix.size(), segmentPrefix) == 0 &&
+        std::sscanf(fname.c_str() + segmentPrefix.size(),
+                    "%llu_%llu_%16[0-9a-f].mp4", &first, &last, key) == 3) {
+      cached.insert({static_cast<size_t>(first),
+                     {static_cast<size_t>(last), key, file.path()}});
+      oldSegments.push_back(file.path());
+    }
+  }
+
+  // Trechos reaproveitados cobrem um prefixo da sequencia; o resto e
+  // dividido entre os novos.
+  struct Segment {
+    size_t first, last;
+    fs::path file;
+    bool reused;
+  };
+  std::vector<Segment> plan;
+  size_t pos = 0;
+  while (cacheable && pos < entries.size()) {
+    const Segment *found = nullptr;
+    auto range = cached.equal_range(pos);
+    for (auto it = range.first; it != range.second && !found; ++it) {
+      const Cached &c = it->second;
+      if (c.last > pos && c.last <= entries.size() &&
+          c.key == segmentKey(pos, c.last)) {
+        plan.push_back({pos, c.last, c.file, true});
+        found = &plan.back();
+      }
+    }
+    if (!found)
+      break;
+    pos = found->last;
+  }
+  const size_t reusedFrames = pos;
+  const size_t remaining = entries.size() - pos;
+
+  size_t n = 0;
+  if (remaining > 0) {
+    n = segments ? segments : cores;
+    n = std::max<size_t>(1, std::min(n, remaining / MIN_SEGMENT_FRAMES));
+  }
+
+  std::vector<std::vector<std::string>> jobs(n);
+  std::vector<fs::path> temps;
+  for (size_t k = 0; k < n; ++k) {
+    const size_t first = pos + remaining * k / n;
+    const size_t last = pos + remaining * (k + 1) / n;
+    const size_t count = last - first;
+    const fs::path segmentFile =
+        cacheable ? dir / (segmentPrefix + std::to_string(first) + '_' +
+                           std::to_string(last) + '_' +
+                           segmentKey(first, last) + ".mp4")
+                  : dir / (segmentPrefix + std::to_string(k) + ".mp4");
+    plan.push_back({first, last, segmentFile, false});
+    std::vector<std::string> &args = jobs[k];
+    args = {"ffmpeg", "-y", "-hide_banner", "-loglevel", "error",
+            "-nostats", "-progress", "pipe:1"};
+    if (ext == "rgba") {
+      const std::string size =
+          std::to_string(width) + 'x' + std::to_string(height);
+      for (const std::string &a :
+           {std::string("-f"), std::string("image2"),
+            std::string("-start_number"), std::to_string(first),
+            std::string("-framerate"), std::to_string(fps),
+            std::string("-c:v"), std::string("rawvideo"),
+            std::string("-pixel_format"), std::string("rgba"),
+            std::string("-video_size"), size, std::string("-i"),
+            (dir / (prefix + "_%04d." + ext)).string()})
+        args.push_back(a);
+    } else {
+      // Duracao por arquivo; a entrada final (sem duracao, ignorada pelo
+      // concat) e o primeiro frame do proximo trecho, ou o ultimo repetido.
+      const fs::path list = dir / (segmentPrefix + std::to_string(k) + ".txt");
+      std::ofstream out(list);
+      out << "ffconcat version 1.0\n" << std::setprecision(12);
+      for (size_t i = first; i < last; ++i)
+        out << "file '" << entries[i].name << "'\nduration "
+            << static_cast<double>(entries[i].repeat) / fps << '\n';
+      out << "file '" << entries[last < entries.size() ? last : last - 1].name
+          << "'\n";
+      temps.push_back(list);
+      for (const char *a : {"-f", "concat", "-safe", "0", "-i"})
+        args.push_back(a);
+      args.push_back(list.string());
+      args.push_back("-fps_mode");
+      args.push_back("vfr");
+    }
+    args.push_back("-frames:v");
+    args.push_back(std::to_string(count));
+    args.insert(args.end(), encoderArgs.begin(), encoderArgs.end());
+    args.push_back(segmentFile.string());
+    if (!cacheable)
+      temps.push_back(segmentFile);
+  }
+
+  if (reusedFrames > 0)
+    std::cout << "[PersistenceDAO] Reaproveitando " << reusedFrames
+              << " frames ja codificados" << '\n';
+  if (n > 0)
+    std::cout << "[PersistenceDAO] Codificando " << remaining
+              << " frames em " << n << " trechos paralelos" << '\n';
+  std::vector<std::atomic<size_t>> done(n);
+  std::vector<std::atomic<pid_t>> pids(n);
+  std::atomic<size_t> finished{0};
+  std::atomic<bool> failed{false};
+  WorkerPool pool(n);
+  for (size_t k = 0; k < n; ++k)
+    pool.submit([&, k] {
+      const bool ok = runProcess(
+          jobs[k], [&pids, k](pid_t pid) { pids[k] = pid; },
+          [&done, k](const std::string &line) {
+            if (line.compare(0, 6, "frame=") == 0)
+              done[k] = std::strtoull(line.c_str() + 6, nullptr, 10);
+          });
+      if (!ok)
+        failed = true;
+      ++finished;
+    });
+
+  bool cancelled = false;
+  auto reportProgress = [&] {
+    size_t total = reusedFrames;
+    for (auto &d : done)
+      total += d;
+    if (onProgress)
+      onProgress(std::min(total, entries.size()), entries.size());
+  };
+  while (finished < n) {
+    if (!cancelled && ((shouldCancel && shouldCancel()) || failed)) {
+      // Falha em um trecho invalida o video inteiro: para os outros tambem.
+      cancelled = true;
+      for (auto &pid : pids)
+        if (pid > 0)
+          kill(pid, SIGTERM);
+    }
+    reportProgress();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  pool.waitIdle();
+  reportProgress();
+
+  bool ok = !cancelled && !failed;
+  if (ok) {
+    const fs::path list = dir / (prefix + "_segments.txt");
+    {
+      std::ofstream out(list);
+      out << "ffconcat version 1.0\n";
+      for (const Segment &segment : plan)
+        out << "file '" << segment.file.filename().string() << "'\n";
+    }
+    temps.push_back(list);
+    ok = runProcess({"ffmpeg", "-y", "-hide_banner", "-loglevel", "error",
+                     "-f", "concat", "-safe", "0", "-i", list.string(), "-c",
+                     "copy", "-movflags", "+faststart", outputFile},
+                    nullptr, [](const std::string &line) {
+                      std::cerr << "[ffmpeg] " << line << '\n';
+                    });
+  }
+  // Trechos que sairam do plano nao voltam a servir; os novos de um export
+  // que falhou podem estar incompletos.
+  for (const fs::path &old : oldSegments)
+    if (std::none_of(plan.begin(), plan.end(),
+                     [&old](const Segment &seg) { return seg.file == old; }))
+      temps.push_back(old);
+  if (!ok)
+    for (const Segment &segment : plan)
+      if (!segment.reused)
+        temps.push_back(segment.file);
+  for (const auto &path : temps)
+    fs::remove(path, ec);
+  if (ok)
+    std::cout << "[PersistenceDAO] Vídeo exportado: " << outputFile << '\n';
+  else if (cancelled && !failed)
+    std::cout << "[PersistenceDAO] Export de video cancelado." << '\n';
+  else
+    std::cerr << "[PersistenceDAO] Falha ao codificar trechos." << '\n';
+  return ok;
+}
+
+bool PersistenceDAO::exportRawVideo(
+    const FrameSource &frames, const std::string &outputFile, int fps,
+    const VideoProgressFn &onProgress,
+    const std::function<bool()> &shouldCancel) const {
+  const size_t total = frames.frameCount();
+  RawFrame frame;
+  if (total == 0 || !frames.readFrame(0, frame)) {
+    std::cerr << "[PersistenceDAO] Nenhum frame para exportar." << '\n';
+    return false;
+  }
+  std::unique_ptr<VideoEncoder> encoder = VideoEncoder::create();
+  if (!encoder->open(outputFile, frame.width, frame.height, fps))
+    return false;
+
+  bool ok = true;
+  bool cancelled = false;
+  size_t skipped = 0;
+  for (size_t i = 0; i < total && ok; ++i) {
+    if (shouldCancel && shouldCancel()) {
+      cancelled = true;
+      break;
+    }
+    if (i > 0 && !frames.readFrame(i, frame)) {
+      ok = false;
+      break;
+    }
+    if (frame.bytes() != encoder->frameBytes()) {
+      ++skipped; // tamanho mudou no meio da captura
+      continue;
+    }
+    for (size_t r = frames.frameRepeat(i); r > 0 && ok; --r) {
+      std::vector<std::uint8_t> buf = encoder->acquire();
+      std::memcpy(buf.data(), frame.pixels.data(), buf.size());
+      ok = encoder->submit(std::move(buf));
+    }
+    if (onProgress)
+      onProgress({i + 1, total, encoder->stats()});
+  }
+  if (cancelled) {
+    encoder->abort();
+    std::error_code ec;
+    fs::remove(outputFile, ec);
+    std::cout << "[PersistenceDAO] Export de video cancelado." << '\n';
+    return false;
+  }
+  ok = encoder->close() && ok;
+  if (skipped)
+    std::cerr << "[PersistenceDAO] " << skipped
+              << " frames com tamanho diferente ignorados." << '\n';
+  if (ok)
+    std::cout << "[PersistenceDAO] Vídeo exportado: " << outputFile << " ("
+              << encoder->framesWritten() << " frames)" << '\n';
+  return ok;
+}
+
+bool PersistenceDAO::exportAnimation(
+    const FrameSource &frames, const std::string &outputFile, int fps,
+    const std::function<void(size_t, size_t)> &onProgress,
+    const std::function<bool()> &shouldCancel) const {
+  const size_t total = frames.frameCount();
+  RawFrame first;
+  if (total == 0 || !frames.readFrame(0, first)) {
+    std::cerr << "[PersistenceDAO] Nenhum frame para exportar." << '\n';
+    return false;
+  }
+  std::unique_ptr<AnimationWriter> writer = AnimationWriter::create(outputFile);
+  if (!writer) {
+    std::cerr << "[PersistenceDAO] Formato de animacao sem suporte: "
+              << outputFile << '\n';
+    return false;
+  }
+  const auto started = std::chrono::steady_clock::now();
+  writer->prepare(frames);
+  if (!writer->open(outputFile, first.width, first.height, fps))
+    return false;
+
+  // Leitura sequencial (barata no store); o writer paraleliza cada lote.
+  std::vector<RawFrame> batch(writer->batchSize());
+  std::vector<size_t> ticks;
+  size_t frameTicks = 0;
+  size_t skipped = 0;
+  bool ok = true;
+  bool cancelled = false;
+  for (size_t i = 0; i < total && ok;) {
+    if (shouldCancel && shouldCancel()) {
+      cancelled = true;
+      break;
+    }
+    ticks.clear();
+    for (; i < total && ticks.size() < batch.size(); ++i) {
+      RawFrame &frame = batch[ticks.size()];
+      if (!frames.readFrame(i, frame)) {
+        ok = false;
+        break;
+      }
+      if (frame.width != first.width || frame.height != first.height) {
+        ++skipped; // tamanho mudou no meio da captura
+        continue;
+      }
+      ticks.push_back(frames.frameRepeat(i));
+      frameTicks += ticks.back();
+    }
+    ok = ok && writer->write(batch, ticks);
+    if (onProgress)
+      onProgress(i, total);
+  }
+  if (cancelled || !ok) {
+    writer->close();
+    std::error_code ec;
+    fs::remove(outputFile, ec);
+    if (cancelled)
+      std::cout << "[PersistenceDAO] Export de animacao cancelado." << '\n';
+    else
+      std::cerr << "[PersistenceDAO] Falha ao exportar " << outputFile << '\n';
+    return false;
+  }
+  ok = writer->close();
+  if (skipped)
+    std::cerr << "[PersistenceDAO] " << skipped
+              << " frames com tamanho diferente ignorados." << '\n';
+  if (ok) {
+    const double seconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - started)
+                               .count();
+    char timing[96];
+    std::snprintf(timing, sizeof(timing), "%.1f s de clip em %.1f s",
+                  static_cast<double>(frameTicks) / std::max(fps, 1), seconds);
+    std::cout << "[PersistenceDAO] Animacao exportada: " << outputFile << " ("
+              << timing << ")" << '\n';
+  }
+  return ok;
 }
 
 bool PersistenceDAO::cancelProcess(pid_t pid) {
@@ -235,8 +1067,9 @@ bool PersistenceDAO::clearTempFiles(const std::string &framesDir,
       break;
     if (entry.is_regular_file()) {
       auto name = entry.path().filename().string();
+      auto ext = entry.path().extension();
       if (name.rfind(prefix + '_', 0) == 0 &&
-          entry.path().extension() == ".png") {
+          (ext == ".png" || ext == ".qoi" || ext == ".rgba" || ext == ".txt")) {
         fs::remove(entry.path(), ec);
         if (!ec)
           ++removed;
@@ -1,23 +1,47 @@
 #pragma once
+#include "AsyncFileWriter.h"
+#include "FrameSource.h"
+#include "FrameWriter.h"
+#include "VideoEncoder.h"
+#include <cstdint>
 #include <string>
 #include <vector>
-#ifndef SFML_FORWARD_DECL_IMAGE
-#define SFML_FORWARD_DECL_IMAGE
-namespace sf {
-class Image;
-}
-#endif
 #include <filesystem>
 #include <functional>
 #include <iomanip>
 
+// Progresso de exportRawVideo: frames da fonte lidos e estado do encoder.
+struct VideoExportProgress {
+  size_t frame = 0;
+  size_t total = 0;
+  EncodeStats encoder;
+};
+using VideoProgressFn = std::function<void(const VideoExportProgress &)>;
+
 class PersistenceDAO {
 public:
+  // Formato dos arquivos de saveFrames (PNG, QOI ou raw); exportMP4 detecta
+  // o formato pelo frame_format.txt gravado junto.
+  void setFrameFormat(const FrameWriterOptions &options) {
+    m_frameFormat = options;
+  }
+  const FrameWriterOptions &frameFormat() const { return m_frameFormat; }
+
+  // Incremental: o manifesto <prefix>_manifest.txt guarda id, hash e arquivo
+  // de cada frame ja gravado, e a geracao da fonte; so os frames posteriores
+  // ao ultimo dele sao escritos (numerados a partir do proximo arquivo). Se o
+  // manifesto nao confere com a fonte (outro formato/tamanho, outra geracao:
+  // captura limpa ou outro processo), o
+  // diretorio e refeito do zero a partir de startIndex. Progresso conta so
+  // os frames novos. Os arquivos sao codificados em paralelo e gravados em
+  // lotes por um AsyncFileWriter (io_uring ou pwrite); onWriteStats recebe
+  // vazao e fila de escrita junto com o progresso.
   bool
-  saveFrames(const std::vector<sf::Image> &frames, const std::string &dirPath,
+  saveFrames(const FrameSource &frames, const std::string &dirPath,
              const std::string &prefix = "frame", int startIndex = 0,
              const std::function<void(size_t, size_t)> &onProgress = nullptr,
-             const std::function<bool()> &shouldCancel = nullptr) const;
+             const std::function<bool()> &shouldCancel = nullptr,
+             const WriteStatsFn &onWriteStats = nullptr) const;
 
   bool exportMP4(const std::string &framesDir, const std::string &outputFile,
                  int fps = 30) const;
@@ -31,8 +55,94 @@ public:
       pid_t &outPid,
       const std::function<void(const std::string &)> &onProgress) const;
 
+  // Mesmo resultado de exportMP4, mas a sequencia e dividida em `segments`
+  // trechos contiguos (0 = um por nucleo) codificados por processos ffmpeg
+  // em paralelo e juntados sem recodificar (concat -c copy). Cada trecho
+  // comeca num keyframe proprio. Progresso soma os frames de todos os
+  // trechos; cancelar encerra todos os processos. Com manifesto, os trechos
+  // ficam no diretorio com o hash do conteudo no nome e sao reaproveitados
+  // enquanto os frames deles nao mudam: exportar de novo so codifica o que
+  // foi salvo desde o ultimo export.
+  bool exportMP4Segmented(
+      const std::string &framesDir, const std::string &outputFile, int fps,
+      size_t segments = 0,
+      const std::function<void(size_t, size_t)> &onProgress = nullptr,
+      const std::function<bool()> &shouldCancel = nullptr,
+      const std::string &prefix = "frame") const;
+
+  // Frames decodificados da fonte vao direto ao encoder (libavcodec no
+  // processo ou stdin do ffmpeg), por uma fila limitada; repeticoes viram
+  // frames repetidos. Cancelar aborta o encoder e remove o arquivo.
+  bool exportRawVideo(const FrameSource &frames, const std::string &outputFile,
+                      int fps, const VideoProgressFn &onProgress = nullptr,
+                      const std::function<bool()> &shouldCancel = nullptr) const;
+
+  // GIF, APNG ou WebP animado (pelo sufixo de outputFile) direto da fonte,
+  // sem ffmpeg. Os frames sao lidos em lotes e quantizados/comprimidos em
+  // paralelo; repeticoes viram duracao. Cancelar remove o arquivo.
+  bool exportAnimation(
+      const FrameSource &frames, const std::string &outputFile, int fps,
+      const std::function<void(size_t, size_t)> &onProgress = nullptr,
+      const std::function<bool()> &shouldCancel = nullptr) const;
+
   static bool cancelProcess(pid_t pid);
 
   bool clearTempFiles(const std::string &framesDir,
                       const std::string &prefix = "frame") const;
+
+private:
+  // Exclusao por diretorio de frames entre threads: dois exports no mesmo
+  // diretorio (E e Shift+M) gravariam os mesmos arquivos e o mesmo
+  // manifesto. O segundo espera o primeiro terminar ou ser cancelado.
+  class DirectoryLock {
+  public:
+    DirectoryLock(const std::string &dirPath,
+                  const std::function<bool()> &shouldCancel);
+    ~DirectoryLock();
+    DirectoryLock(const DirectoryLock &) = delete;
+    DirectoryLock &operator=(const DirectoryLock &) = delete;
+    // false se o pedido foi cancelado antes de conseguir o diretorio.
+    bool held() const { return m_held; }
+
+  private:
+    std::string m_key;
+    bool m_held = false;
+  };
+
+  struct ManifestEntry {
+    size_t id = 0;            // FrameSource::frameId
+    std::uint64_t hash = 0;   // hashFrame dos pixels
+    size_t fileIndex = 0;     // numero do arquivo (o primeiro, se expandido)
+    size_t repeat = 1;
+    std::string file;
+  };
+  static std::uint64_t hashFrame(const RawFrame &frame);
+  // false se nao existe ou foi gravado com outro formato/tamanho.
+  // generation: FrameSource::generation da fonte que gravou os frames.
+  static bool loadManifest(const std::string &dirPath, const std::string &prefix,
+                           const std::string &ext, unsigned width,
+                           unsigned height, std::uint64_t &generation,
+                           std::vector<ManifestEntry> &out);
+  static bool writeManifest(const std::string &dirPath,
+                            const std::string &prefix, const std::string &ext,
+                            unsigned width, unsigned height,
+                            std::uint64_t generation,
+                            const std::vector<ManifestEntry> &entries);
+
+  // Entrada do ffmpeg: sequencia <prefix>_%04d.<ext> (rawvideo via image2
+  // para raw) ou, se saveFrames gravou <prefix>_runs.txt, lista do concat
+  // demuxer com duracoes (VFR).
+  std::vector<std::string> inputArgs(const std::string &framesDir, int fps,
+                                     const std::string &prefix = "frame") const;
+  static std::string shellJoin(const std::vector<std::string> &args);
+  // Roda `args` (args[0] = programa) num processo filho e passa cada linha
+  // de stdout/stderr a onLine. onPid recebe o pid ao iniciar e 0 quando a
+  // saida fecha. true se o processo terminou com codigo 0.
+  static bool runProcess(const std::vector<std::string> &args,
+                         const std::function<void(pid_t)> &onPid,
+                         const std::function<void(const std::string &)> &onLine);
+
+  static constexpr size_t MIN_SEGMENT_FRAMES = 120;
+
+  FrameWriterOptions m_frameFormat;
 };
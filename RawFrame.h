@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Frame RGBA (8 bits por canal, linha 0 no topo), sem dono de recurso grafico.
+struct RawFrame {
+    unsigned width = 0;
+    unsigned height = 0;
+    std::vector<std::uint8_t> pixels;
+
+    size_t bytes() const { return static_cast<size_t>(width) * height * 4; }
+    bool empty() const { return pixels.empty(); }
+    // Reaproveita a capacidade ja alocada quando o tamanho nao muda.
+    void resize(unsigned w, unsigned h) {
+        width = w;
+        height = h;
+        pixels.resize(bytes());
+    }
+};
+
+// Visao sem copia de pixels RGBA de outro dono (ex.: PBO mapeado). Leituras
+// do OpenGL vem com a linha de baixo primeiro (bottomUp).
+struct FrameView {
+    const std::uint8_t* pixels = nullptr;
+    unsigned width = 0;
+    unsigned height = 0;
+    size_t stride = 0;
+    bool bottomUp = false;
+
+    const std::uint8_t* row(unsigned y) const {
+        return pixels + (bottomUp ? height - 1 - y : y) * stride;
+    }
+};
+
+// Recorte sem copia: o retangulo pedido (cortado aos limites da view).
+// Largura/altura <= 0 pegam a view inteira; fora da view da width 0.
+inline FrameView subView(const FrameView& view, int x, int y, int w, int h) {
+    if (w <= 0 || h <= 0) {
+        x = y = 0;
+        w = static_cast<int>(view.width);
+        h = static_cast<int>(view.height);
+    }
+    const int left = std::max(x, 0);
+    const int top = std::max(y, 0);
+    const int right = std::min(x + w, static_cast<int>(view.width));
+    const int bottom = std::min(y + h, static_cast<int>(view.height));
+    FrameView sub = view;
+    if (right <= left || bottom <= top) {
+        sub.width = sub.height = 0;
+        return sub;
+    }
+    sub.width = static_cast<unsigned>(right - left);
+    sub.height = static_cast<unsigned>(bottom - top);
+    // De baixo para cima, a primeira linha na memoria e a de baixo do recorte.
+    const size_t firstRow = view.bottomUp ? view.height - static_cast<unsigned>(bottom)
+                                          : static_cast<unsigned>(top);
+    sub.pixels = view.pixels + firstRow * view.stride + static_cast<size_t>(left) * 4;
+    return sub;
+}
+
+// Copia so o retangulo pedido para out, ja com a linha 0 no topo.
+inline void copyRegion(const FrameView& view, int x, int y, int w, int h, RawFrame& out) {
+    const FrameView sub = subView(view, x, y, w, h);
+    out.resize(sub.width, sub.height);
+    const size_t rowBytes = static_cast<size_t>(out.width) * 4;
+    for (unsigned r = 0; r < out.height; ++r)
+        std::memcpy(out.pixels.data() + r * rowBytes, sub.row(r), rowBytes);
+}
@@ -0,0 +1,33 @@
+#include "RenderLayer.h"
+
+bool RenderLayer::resize(sf::Vector2u size) {
+  if (size == m_size)
+    return true;
+  m_dirty = true;
+  // So guarda o tamanho se a textura existe: depois de uma falha, o mesmo
+  // tamanho tenta de novo em vez de devolver true para uma camada quebrada.
+  if (!m_texture.create(size.x, size.y)) {
+    m_size = sf::Vector2u();
+    return false;
+  }
+  m_size = size;
+  return true;
+}
+
+sf::RenderTarget &RenderLayer::begin(const sf::Color &clearColor) {
+  m_texture.setView(m_texture.getDefaultView());
+  m_texture.clear(clearColor);
+  m_dirty = false;
+  return m_texture;
+}
+
+void RenderLayer::end() { m_texture.display(); }
+
+void RenderLayer::composite(sf::RenderTarget &target) const {
+  // A camada ja guarda cor pre-multiplicada (BlendAlpha do SFML acumula o
+  // alfa com One/OneMinusSrcAlpha), entao compoe sem multiplicar de novo.
+  static const sf::BlendMode premultiplied(sf::BlendMode::One,
+                                           sf::BlendMode::OneMinusSrcAlpha);
+  sf::Sprite sprite(m_texture.getTexture());
+  target.draw(sprite, sf::RenderStates(premultiplied));
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+
+// Camada de desenho em cache (sf::RenderTexture do tamanho da janela). So e
+// redesenhada quando invalidada; a composicao na janela e um unico sprite.
+class RenderLayer {
+public:
+    // Recria a textura se o tamanho mudou; retorna false em falha.
+    bool resize(sf::Vector2u size);
+    void invalidate() { m_dirty = true; }
+    bool dirty() const { return m_dirty; }
+
+    // Limpa a camada e a deixa pronta para desenho (marca como limpa).
+    sf::RenderTarget& begin(const sf::Color& clearColor = sf::Color::Transparent);
+    void end();
+
+    void composite(sf::RenderTarget& target) const;
+
+private:
+    sf::RenderTexture m_texture;
+    sf::Vector2u m_size;
+    bool m_dirty = true;
+};
@@ -0,0 +1,51 @@
+#include "ShapeBatch.h"
+
+void ShapeBatch::clear() {
+  m_fills.clear();
+  m_lines.clear();
+}
+
+void ShapeBatch::reserve(size_t rects, size_t lines) {
+  // sf::VertexArray nao expoe reserve(); resize + clear mantem a capacidade
+  // do std::vector interno para os proximos appends.
+  m_fills.resize(rects * 6);
+  m_fills.clear();
+  m_lines.resize(lines * 2);
+  m_lines.clear();
+}
+
+void ShapeBatch::addRect(sf::Vector2f pos, sf::Vector2f size, sf::Color color) {
+  if (color.a == 0 || size.x <= 0.f || size.y <= 0.f)
+    return;
+  sf::Vector2f tl = pos;
+  sf::Vector2f tr = {pos.x + size.x, pos.y};
+  sf::Vector2f br = {pos.x + size.x, pos.y + size.y};
+  sf::Vector2f bl = {pos.x, pos.y + size.y};
+  m_fills.append(sf::Vertex(tl, color));
+  m_fills.append(sf::Vertex(tr, color));
+  m_fills.append(sf::Vertex(br, color));
+  m_fills.append(sf::Vertex(tl, color));
+  m_fills.append(sf::Vertex(br, color));
+  m_fills.append(sf::Vertex(bl, color));
+}
+
+void ShapeBatch::addOutline(sf::Vector2f pos, sf::Vector2f size,
+                            float thickness, sf::Color color) {
+  float t = thickness;
+  addRect({pos.x - t, pos.y - t}, {size.x + 2.f * t, t}, color);
+  addRect({pos.x - t, pos.y + size.y}, {size.x + 2.f * t, t}, color);
+  addRect({pos.x - t, pos.y}, {t, size.y}, color);
+  addRect({pos.x + size.x, pos.y}, {t, size.y}, color);
+}
+
+void ShapeBatch::addLine(sf::Vector2f a, sf::Vector2f b, sf::Color color) {
+  m_lines.append(sf::Vertex(a, color));
+  m_lines.append(sf::Vertex(b, color));
+}
+
+void ShapeBatch::draw(sf::RenderTarget &target) const {
+  if (m_fills.getVertexCount() > 0)
+    target.draw(m_fills);
+  if (m_lines.getVertexCount() > 0)
+    target.draw(m_lines);
+}
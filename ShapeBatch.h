@@ -0,0 +1,23 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+
+// Acumula retangulos, contornos e linhas em vertex arrays persistentes para
+// que um visualizador inteiro seja desenhado com poucas chamadas de draw.
+class ShapeBatch {
+public:
+    ShapeBatch() : m_fills(sf::Triangles), m_lines(sf::Lines) {}
+
+    void clear();
+    void reserve(size_t rects, size_t lines);
+
+    void addRect(sf::Vector2f pos, sf::Vector2f size, sf::Color color);
+    // Contorno externo, mesma geometria de sf::Shape::setOutlineThickness.
+    void addOutline(sf::Vector2f pos, sf::Vector2f size, float thickness, sf::Color color);
+    void addLine(sf::Vector2f a, sf::Vector2f b, sf::Color color);
+
+    void draw(sf::RenderTarget& target) const;
+
+private:
+    sf::VertexArray m_fills;
+    sf::VertexArray m_lines;
+};
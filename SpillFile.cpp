@@ -0,0 +1,69 @@
+#include "SpillFile.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <iostream>
+#include <sys/mman.h>
+#include <unistd.h>
+
+bool SpillFile::open(size_t capacity) {
+  close();
+  if (capacity == 0)
+    return false;
+  std::error_code ec;
+  auto dir = std::filesystem::temp_directory_path(ec);
+  if (ec)
+    dir = "/tmp";
+  std::string pattern = (dir / "visualizador-frames-XXXXXX").string();
+  m_fd = mkstemp(pattern.data());
+  if (m_fd < 0) {
+    std::cerr << "[SpillFile] Falha ao criar " << pattern << ": "
+              << std::strerror(errno) << '\n';
+    return false;
+  }
+  unlink(pattern.c_str());
+  void *base =
+      mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+  if (base == MAP_FAILED) {
+    std::cerr << "[SpillFile] mmap falhou: " << std::strerror(errno) << '\n';
+    ::close(m_fd);
+    m_fd = -1;
+    return false;
+  }
+  m_base = static_cast<std::uint8_t *>(base);
+  m_capacity = capacity;
+  m_allocated = 0;
+  return true;
+}
+
+void SpillFile::close() {
+  if (m_base)
+    munmap(m_base, m_capacity);
+  if (m_fd >= 0)
+    ::close(m_fd);
+  m_base = nullptr;
+  m_fd = -1;
+  m_capacity = 0;
+  m_allocated = 0;
+}
+
+bool SpillFile::reserve(size_t end) {
+  if (end <= m_allocated)
+    return true;
+  if (!m_base || end > m_capacity)
+    return false;
+  // Aloca de verdade (nao esparso): escrever num buraco sem espaco em disco
+  // viraria SIGBUS no acesso ao mapeamento.
+  const size_t target = std::min(m_capacity, (end + CHUNK - 1) / CHUNK * CHUNK);
+  const int err = posix_fallocate(m_fd, static_cast<off_t>(m_allocated),
+                                  static_cast<off_t>(target - m_allocated));
+  if (err != 0) {
+    std::cerr << "[SpillFile] Sem espaco em disco: " << std::strerror(err)
+              << '\n';
+    return false;
+  }
+  m_allocated = target;
+  return true;
+}
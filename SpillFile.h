@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Arquivo temporario mapeado em memoria, usado como extensao em disco de um
+// store de frames. O mapeamento cobre a capacidade inteira desde o open(), entao
+// ponteiros para dentro dele nunca mudam; o disco e alocado aos poucos em
+// reserve(). O arquivo e removido do diretorio logo apos ser criado e some
+// quando o objeto e destruido.
+class SpillFile {
+public:
+    SpillFile() = default;
+    ~SpillFile() { close(); }
+
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    bool open(size_t capacity);
+    void close();
+    bool isOpen() const { return m_base != nullptr; }
+    size_t capacity() const { return m_capacity; }
+    size_t allocated() const { return m_allocated; }
+
+    // Garante espaco em disco para [0, end); false se o disco encheu.
+    bool reserve(size_t end);
+    std::uint8_t* data() const { return m_base; }
+
+private:
+    static constexpr size_t CHUNK = 64u << 20;
+
+    int m_fd = -1;
+    std::uint8_t* m_base = nullptr;
+    size_t m_capacity = 0;
+    size_t m_allocated = 0;
+};
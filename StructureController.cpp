@@ -198,3 +198,15 @@ void StructureController::highlightAt(size_t idx) {
   if (m_structure && m_structure->size() > idx && m_visualizer)
     m_visualizer->highlight(idx);
 }
+
+bool StructureController::replay(const RecordedCommand &cmd) {
+  if (cmd.op == "INSERT" && cmd.hasValue)
+    insertAt(cmd.index, cmd.value);
+  else if (cmd.op == "REMOVE")
+    removeAt(cmd.index);
+  else if (cmd.op == "HIGHLIGHT")
+    highlightAt(cmd.index);
+  else
+    return false;
+  return true;
+}
@@ -17,7 +17,10 @@ public:
     void insertAt(size_t idx, int val);
     void removeAt(size_t idx);
     void highlightAt(size_t idx);
-    void connect() { if (m_structure && m_visualizer) m_visualizer->render(m_structure->getState()); }
+    // Reaplica um comando gravado (INSERT/REMOVE/HIGHLIGHT); false se ignorado.
+    bool replay(const RecordedCommand& cmd);
+    const AbstractDataStructure* structure() const { return m_structure.get(); }
+    void connect() { if (m_structure && m_visualizer) m_visualizer->sync(m_structure->getState()); }
     void runAnimation() {  }
     void exportFrames(const std::string& path) { if (m_visualizer) m_visualizer->exportFrames(path); }
 private:
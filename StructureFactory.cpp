@@ -9,3 +9,9 @@ std::unique_ptr<AbstractDataStructure> StructureFactory::create(const std::strin
     if (type == "linked_list") return std::make_unique<LinkedListStructure>();
     return nullptr;
 }
+
+std::unique_ptr<AbstractDataStructure> StructureFactory::create(const std::string& type, size_t capacity) {
+    if (type == "array") return std::make_unique<ArrayStructure>(capacity);
+    if (type == "array_list") return std::make_unique<ArrayListStructure>(capacity);
+    return create(type);
+}
@@ -6,4 +6,5 @@
 class StructureFactory {
 public:
     std::unique_ptr<AbstractDataStructure> create(const std::string& type);
+    std::unique_ptr<AbstractDataStructure> create(const std::string& type, size_t capacity);
 };
@@ -0,0 +1,52 @@
+#include "SubtitleRing.h"
+#include <algorithm>
+
+SubtitleRing::SubtitleRing(const sf::Font &font, float duration,
+                           unsigned characterSize)
+    : m_duration(duration) {
+  for (auto &e : m_entries) {
+    e.text.setFont(font);
+    e.text.setCharacterSize(characterSize);
+  }
+}
+
+void SubtitleRing::push(const std::string &text) {
+  size_t slot = (m_oldest + m_count) % CAPACITY;
+  if (m_count == CAPACITY) {
+    m_oldest = (m_oldest + 1) % CAPACITY;
+  } else {
+    ++m_count;
+  }
+  Entry &e = m_entries[slot];
+  e.age = 0.f;
+  e.text.setString(text);
+  sf::FloatRect b = e.text.getLocalBounds();
+  e.text.setOrigin(b.left + b.width / 2.f, b.top + b.height / 2.f);
+}
+
+bool SubtitleRing::update(float dt) {
+  for (size_t i = 0; i < m_count; ++i)
+    m_entries[(m_oldest + i) % CAPACITY].age += dt;
+  // A mais antiga sempre expira primeiro.
+  bool expired = false;
+  while (m_count > 0 && m_entries[m_oldest].age > m_duration) {
+    m_oldest = (m_oldest + 1) % CAPACITY;
+    --m_count;
+    expired = true;
+  }
+  return expired;
+}
+
+void SubtitleRing::draw(sf::RenderTarget &target, sf::Vector2f newestCenter,
+                        float lineSpacing) {
+  for (size_t line = 0; line < m_count; ++line) {
+    Entry &e = m_entries[(m_oldest + m_count - 1 - line) % CAPACITY];
+    float alphaRatio =
+        std::max(0.f, m_duration - e.age) / m_duration; // fade out
+    e.text.setFillColor(
+        sf::Color(230, 230, 230, static_cast<sf::Uint8>(alphaRatio * 255)));
+    e.text.setPosition(newestCenter.x,
+                       newestCenter.y - static_cast<float>(line) * lineSpacing);
+    target.draw(e.text);
+  }
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <string>
+
+// Legendas temporarias em um buffer circular de capacidade fixa. Cada
+// entrada guarda o sf::Text ja montado (string e origem centralizada), de
+// modo que o desenho so ajusta cor e posicao.
+class SubtitleRing {
+public:
+    static constexpr size_t CAPACITY = 12;
+
+    SubtitleRing(const sf::Font& font, float duration = 3.5f, unsigned characterSize = 16);
+
+    void push(const std::string& text);
+    // Envelhece as legendas e descarta as expiradas; true se alguma expirou.
+    bool update(float dt);
+    void draw(sf::RenderTarget& target, sf::Vector2f newestCenter, float lineSpacing = 22.f);
+
+    bool empty() const { return m_count == 0; }
+    size_t size() const { return m_count; }
+
+private:
+    struct Entry {
+        sf::Text text;
+        float age = 0.f;
+    };
+
+    std::array<Entry, CAPACITY> m_entries;
+    size_t m_oldest = 0;
+    size_t m_count = 0;
+    float m_duration;
+};
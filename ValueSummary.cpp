@@ -0,0 +1,44 @@
+#include "ValueSummary.h"
+#include <algorithm>
+
+void ValueSummary::rebuild(const std::vector<VisualNode> &nodes) {
+  m_nodes = &nodes;
+  size_t blocks = (nodes.size() + BLOCK - 1) / BLOCK;
+  m_blockPrefix.assign(blocks + 1, 0);
+  m_min = nodes.empty() ? 0 : nodes.front().value;
+  m_max = m_min;
+  std::int64_t running = 0;
+  for (size_t b = 0; b < blocks; ++b) {
+    size_t end = std::min(nodes.size(), (b + 1) * BLOCK);
+    for (size_t i = b * BLOCK; i < end; ++i) {
+      int v = nodes[i].value;
+      running += v;
+      m_min = std::min(m_min, v);
+      m_max = std::max(m_max, v);
+    }
+    m_blockPrefix[b + 1] = running;
+  }
+}
+
+double ValueSummary::mean(size_t first, size_t last) const {
+  if (!m_nodes)
+    return 0.0;
+  last = std::min(last, m_nodes->size());
+  if (first >= last)
+    return 0.0;
+  const auto &nodes = *m_nodes;
+  std::int64_t sum = 0;
+  size_t firstFull = (first + BLOCK - 1) / BLOCK;
+  size_t lastFull = last / BLOCK;
+  if (firstFull >= lastFull) {
+    for (size_t i = first; i < last; ++i)
+      sum += nodes[i].value;
+  } else {
+    for (size_t i = first; i < firstFull * BLOCK; ++i)
+      sum += nodes[i].value;
+    sum += m_blockPrefix[lastFull] - m_blockPrefix[firstFull];
+    for (size_t i = lastFull * BLOCK; i < last; ++i)
+      sum += nodes[i].value;
+  }
+  return static_cast<double>(sum) / static_cast<double>(last - first);
+}
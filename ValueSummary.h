@@ -0,0 +1,25 @@
+#pragma once
+#include "AnimationStep.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Resumo dos valores dos nos (soma prefixada por bloco, min e max globais).
+// Permite tirar a media de qualquer intervalo contiguo em O(BLOCK) para o
+// modo de nivel de detalhe, mesmo com milhoes de elementos.
+class ValueSummary {
+public:
+    static constexpr std::size_t BLOCK = 256;
+
+    void rebuild(const std::vector<VisualNode>& nodes);
+    double mean(std::size_t first, std::size_t last) const;
+    int minValue() const { return m_min; }
+    int maxValue() const { return m_max; }
+    std::size_t size() const { return m_nodes ? m_nodes->size() : 0; }
+
+private:
+    const std::vector<VisualNode>* m_nodes = nullptr;
+    std::vector<std::int64_t> m_blockPrefix; // soma dos blocos [0, b)
+    int m_min = 0;
+    int m_max = 0;
+};
@@ -2,7 +2,13 @@
 
 VectorVisualizer::VectorVisualizer(sf::Font &font, const sf::Vector2f &position)
     : m_font(font), m_position(position),
-      m_layout(std::make_unique<LinearLayoutPolicy>(BOX_WIDTH, SPACING)) {}
+      m_layout(std::make_unique<LinearLayoutPolicy>(BOX_WIDTH, SPACING)),
+      m_title("std::vector (Array List)", font, 20),
+      m_valueGlyphs(font, FONT_SIZE), m_indexGlyphs(font, FONT_SIZE - 8),
+      m_valueLabels(sf::Triangles), m_indexLabels(sf::Triangles) {
+  m_title.setPosition(m_position.x, m_position.y - 40);
+  m_title.setFillColor(sf::Color::White);
+}
 
 void VectorVisualizer::insert(int value, size_t index) {
   std::string desc = "Vetor: Insert(" + std::to_string(value) + ", " +
@@ -67,15 +73,6 @@ sf::Vector2f VectorVisualizer::getPositionForIndex(size_t i) const {
 }
 
 void VectorVisualizer::reflow(float windowWidth, float panelWidth) {
-  if (!isIdle())
-    return;
-  bool widthChanged = (windowWidth != m_lastLayoutWidth);
-  bool countChanged = (m_lastNodeCount != m_nodes.size());
-  if (!widthChanged && !countChanged)
-    return;
-  m_lastLayoutWidth = windowWidth;
-  m_lastNodeCount = m_nodes.size();
-
   float margin = 40.f;
   float available =
       std::max(180.f, windowWidth - panelWidth - m_position.x - margin);
@@ -84,48 +81,71 @@ void VectorVisualizer::reflow(float windowWidth, float panelWidth) {
   if (maxCols < 1)
     maxCols = 1;
   float rowHeight = BOX_HEIGHT + 65.f;
+  GridLayout grid{m_position, static_cast<size_t>(maxCols), stride,
+                  rowHeight};
+  // A grade vale ja durante animacoes: LOD e faixas de valores dependem
+  // dela desde o primeiro frame. So o reposicionamento espera o fim.
+  m_grid = grid;
+  if (!isIdle())
+    return;
 
-  for (size_t i = 0; i < m_nodes.size(); ++i) {
-    int row = static_cast<int>(i / maxCols);
-    int col = static_cast<int>(i % maxCols);
-    float x = m_position.x + col * stride;
-    float y = m_position.y + row * rowHeight;
-    m_nodes[i].position = {x, y};
-  }
+  // So os nos nas linhas visiveis sao posicionados; os demais entram no
+  // layout quando a camera chega ate eles.
+  IndexRange range = visibleRange(grid);
+  bool widthChanged = (windowWidth != m_lastLayoutWidth);
+  bool countChanged = (m_lastNodeCount != m_nodes.size());
+  bool rangeChanged = (range != m_lastLayoutRange);
+  if (!widthChanged && !countChanged && !rangeChanged)
+    return;
+  m_lastLayoutWidth = windowWidth;
+  m_lastNodeCount = m_nodes.size();
+  m_lastLayoutRange = range;
+
+  for (size_t i = range.first; i < range.last; ++i)
+    m_nodes[i].position = grid.positionForIndex(i);
+  markDirty();
 }
 
-void VectorVisualizer::draw(sf::RenderWindow &window) const {
-  sf::Text title("std::vector (Array List)", m_font, 20);
-  title.setPosition(m_position.x, m_position.y - 40);
-  title.setFillColor(sf::Color::White);
-  window.draw(title);
+void VectorVisualizer::rebuildBatch() const {
+  m_batch.clear();
+  m_valueLabels.clear();
+  m_indexLabels.clear();
+  if (useValueStrips()) {
+    appendValueStrips(m_batch, BOX_WIDTH);
+    return;
+  }
 
-  for (size_t i = 0; i < m_nodes.size(); ++i) {
+  IndexRange range = drawRange();
+  bool labels = showLabels(BOX_WIDTH);
+  m_batch.reserve((range.last - range.first) * 4, 0);
+  const sf::Vector2f size(BOX_WIDTH, BOX_HEIGHT);
+  const sf::Color indexColor(180, 180, 180);
+  for (size_t i = range.first; i < range.last; ++i) {
     const auto &node = m_nodes[i];
-    sf::RectangleShape box(sf::Vector2f(BOX_WIDTH, BOX_HEIGHT));
-    box.setPosition(node.position);
-    box.setFillColor(sf::Color::Transparent);
-    box.setOutlineColor(node.color);
-    box.setOutlineThickness(2.f);
-
-    sf::Text valueText(std::to_string(node.value), m_font, FONT_SIZE);
-    valueText.setFillColor(sf::Color::White);
-    sf::FloatRect textBounds = valueText.getLocalBounds();
-    valueText.setOrigin(textBounds.left + textBounds.width / 2.f,
-                        textBounds.top + textBounds.height / 2.f);
-    valueText.setPosition(node.position.x + BOX_WIDTH / 2.f,
-                          node.position.y + BOX_HEIGHT / 2.f);
-
-    sf::Text indexText("[" + std::to_string(i) + "]", m_font, FONT_SIZE - 8);
-    indexText.setFillColor(sf::Color(180, 180, 180));
-    sf::FloatRect indexBounds = indexText.getLocalBounds();
-    indexText.setOrigin(indexBounds.left + indexBounds.width / 2.f,
-                        indexBounds.top);
-    indexText.setPosition(getPositionForIndex(i).x + BOX_WIDTH / 2.f,
-                          m_position.y + BOX_HEIGHT + 5);
-
-    window.draw(box);
-    window.draw(valueText);
-    window.draw(indexText);
+    if (!isOnScreen(node.position, size))
+      continue;
+    m_batch.addOutline(node.position, size, 2.f, node.color);
+    if (!labels)
+      continue;
+    m_valueGlyphs.appendNumber(m_valueLabels, node.value,
+                               {node.position.x + BOX_WIDTH / 2.f,
+                                node.position.y + BOX_HEIGHT / 2.f},
+                               sf::Color::White);
+    sf::Vector2f cell = m_grid.positionForIndex(i);
+    m_indexGlyphs.appendIndex(
+        m_indexLabels, i,
+        {cell.x + BOX_WIDTH / 2.f, cell.y + BOX_HEIGHT + 5}, indexColor);
+  }
+}
+
+void VectorVisualizer::draw(sf::RenderTarget &target) const {
+  target.draw(m_title);
+
+  if (m_dirty) {
+    rebuildBatch();
+    m_dirty = false;
   }
+  m_batch.draw(target);
+  target.draw(m_valueLabels, sf::RenderStates(&m_valueGlyphs.texture()));
+  target.draw(m_indexLabels, sf::RenderStates(&m_indexGlyphs.texture()));
 }
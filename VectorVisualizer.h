@@ -1,6 +1,8 @@
 #pragma once
 #include "Visualizer.h"
 #include "LayoutPolicy.h"
+#include "GlyphAtlas.h"
+#include "ShapeBatch.h"
 
 class VectorVisualizer final : public Visualizer {
 public:
@@ -10,7 +12,7 @@ public:
     void remove(size_t index);
     void clearAnimated();
     
-    void draw(sf::RenderWindow& window) const override;
+    void draw(sf::RenderTarget& target) const override;
     void reflow(float windowWidth, float panelWidth=280.f);
 
 private:
@@ -18,6 +20,7 @@ private:
     void buildRemoveAnimation(size_t index);
 
     sf::Vector2f getPositionForIndex(size_t i) const;
+    void rebuildBatch() const;
 
     sf::Font& m_font;
     sf::Vector2f m_position;
@@ -29,4 +32,12 @@ private:
     static constexpr int FONT_SIZE = 24;
     float m_lastLayoutWidth = 0.f;
     size_t m_lastNodeCount = 0;
+    IndexRange m_lastLayoutRange;
+
+    sf::Text m_title;
+    mutable ShapeBatch m_batch;
+    mutable GlyphAtlas m_valueGlyphs;
+    mutable GlyphAtlas m_indexGlyphs;
+    mutable sf::VertexArray m_valueLabels;
+    mutable sf::VertexArray m_indexLabels;
 };
@@ -0,0 +1,140 @@
+#include "VideoEncoder.h"
+#include "VideoEncoderPipe.h"
+#ifdef HAVE_LIBAV
+#include "LibavEncoder.h"
+#endif
+#include <filesystem>
+#include <iostream>
+
+std::unique_ptr<VideoEncoder> VideoEncoder::create(size_t queueDepth) {
+#ifdef HAVE_LIBAV
+  return std::make_unique<LibavEncoder>(queueDepth);
+#else
+  return std::make_unique<VideoEncoderPipe>(queueDepth);
+#endif
+}
+
+bool VideoEncoder::open(const std::string &outputFile, unsigned width,
+                        unsigned height, double fps, const std::string &preset) {
+  if (m_open || width == 0 || height == 0 || fps <= 0.0)
+    return false;
+  if (!start(outputFile, width, height, fps, preset))
+    return false;
+  m_file = outputFile;
+  m_width = width;
+  m_height = height;
+  m_fps = fps;
+  m_started = std::chrono::steady_clock::now();
+  m_written = 0;
+  m_closing = false;
+  m_failed = false;
+  m_open = true;
+  m_writer = std::thread(&VideoEncoder::writerLoop, this);
+  return true;
+}
+
+std::vector<std::uint8_t> VideoEncoder::acquire() {
+  std::unique_lock<std::mutex> lk(m_mutex);
+  // Fila cheia + um frame sendo escrito + um sendo preenchido.
+  if (m_free.empty() && m_allocated < m_queueDepth + 2) {
+    ++m_allocated;
+    lk.unlock();
+    return std::vector<std::uint8_t>(frameBytes());
+  }
+  m_cv.wait(lk, [this] { return !m_free.empty() || m_failed; });
+  if (m_free.empty())
+    return std::vector<std::uint8_t>(frameBytes());
+  std::vector<std::uint8_t> buf = std::move(m_free.back());
+  m_free.pop_back();
+  return buf;
+}
+
+bool VideoEncoder::submit(std::vector<std::uint8_t> frame) {
+  if (!m_open || frame.size() != frameBytes())
+    return false;
+  std::unique_lock<std::mutex> lk(m_mutex);
+  m_cv.wait(lk, [this] { return m_queue.size() < m_queueDepth || m_failed; });
+  if (m_failed)
+    return false;
+  m_queue.push_back(std::move(frame));
+  m_cv.notify_all();
+  return true;
+}
+
+void VideoEncoder::release(std::vector<std::uint8_t> frame) {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  frame.resize(frameBytes());
+  m_free.push_back(std::move(frame));
+  m_cv.notify_all();
+}
+
+void VideoEncoder::writerLoop() {
+  while (true) {
+    std::vector<std::uint8_t> frame;
+    {
+      std::unique_lock<std::mutex> lk(m_mutex);
+      m_cv.wait(lk, [this] { return !m_queue.empty() || m_closing; });
+      if (m_queue.empty())
+        return;
+      frame = std::move(m_queue.front());
+      m_queue.pop_front();
+    }
+    const bool ok = write(frame);
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (ok) {
+      ++m_written;
+    } else if (!m_failed) {
+      std::cerr << "[VideoEncoder] Falha ao codificar frame " << m_written
+                << '\n';
+      m_failed = true;
+      m_queue.clear();
+    }
+    m_free.push_back(std::move(frame));
+    m_cv.notify_all();
+  }
+}
+
+bool VideoEncoder::stop(bool aborted) {
+  if (!m_open)
+    return false;
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (aborted)
+      m_queue.clear();
+    m_closing = true;
+  }
+  m_cv.notify_all();
+  if (m_writer.joinable())
+    m_writer.join();
+  const bool ok = finish(aborted);
+  m_open = false;
+  m_free.clear();
+  m_allocated = 0;
+  return ok && !m_failed;
+}
+
+bool VideoEncoder::close() { return stop(false); }
+
+void VideoEncoder::abort() { stop(true); }
+
+size_t VideoEncoder::framesWritten() const {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  return m_written;
+}
+
+size_t VideoEncoder::outputBytes() const {
+  std::error_code ec;
+  const auto size = std::filesystem::file_size(m_file, ec);
+  return ec ? 0 : static_cast<size_t>(size);
+}
+
+EncodeStats VideoEncoder::stats() const {
+  EncodeStats s;
+  s.frames = framesWritten();
+  s.bytes = outputBytes();
+  s.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            m_started)
+                  .count();
+  s.fps = m_fps;
+  return s;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Estado de um encoder de video, para progresso estruturado.
+struct EncodeStats {
+    size_t frames = 0;   // frames ja entregues ao encoder
+    size_t bytes = 0;    // bytes de video gerados ate agora
+    double seconds = 0;  // tempo desde open()
+    double fps = 0;      // taxa do video (para a velocidade em tempo real)
+
+    double framesPerSecond() const { return seconds > 0 ? frames / seconds : 0.0; }
+    // Segundos de video por segundo de relogio (1.0 = tempo real).
+    double speed() const { return fps > 0 ? framesPerSecond() / fps : 0.0; }
+};
+
+// Encoder de frames RGBA crus. Uma thread propria esvazia uma fila limitada;
+// quando a fila enche, submit() bloqueia (backpressure) em vez de acumular
+// memoria. As subclasses so implementam abrir, escrever um frame e fechar.
+class VideoEncoder {
+public:
+    explicit VideoEncoder(size_t queueDepth = 4) : m_queueDepth(queueDepth ? queueDepth : 1) {}
+    // Subclasses chamam close() no proprio destrutor (finish() e virtual).
+    virtual ~VideoEncoder() = default;
+
+    VideoEncoder(const VideoEncoder&) = delete;
+    VideoEncoder& operator=(const VideoEncoder&) = delete;
+
+    // libavcodec em processo quando compilado com HAVE_LIBAV; senao ffmpeg
+    // por pipe.
+    static std::unique_ptr<VideoEncoder> create(size_t queueDepth = 4);
+
+    bool open(const std::string& outputFile, unsigned width, unsigned height, double fps,
+              const std::string& preset = "veryfast");
+    // Buffer de width*height*4 bytes, reaproveitado entre frames.
+    std::vector<std::uint8_t> acquire();
+    bool submit(std::vector<std::uint8_t> frame);
+    // Devolve ao pool um buffer de acquire() que nao sera enviado.
+    void release(std::vector<std::uint8_t> frame);
+    // Espera a fila esvaziar e finaliza o arquivo; true se tudo deu certo.
+    bool close();
+    // Cancelamento: descarta a fila e fecha sem finalizar. O arquivo de
+    // saida fica incompleto; quem cancela decide se o remove.
+    void abort();
+
+    // yuv420p exige largura e altura pares; este filtro do ffmpeg completa
+    // com uma coluna/linha preta quando a captura tem tamanho impar.
+    static constexpr const char* EVEN_SIZE_FILTER = "pad=ceil(iw/2)*2:ceil(ih/2)*2";
+
+    bool isOpen() const { return m_open; }
+    size_t framesWritten() const;
+    size_t frameBytes() const { return static_cast<size_t>(m_width) * m_height * 4; }
+    EncodeStats stats() const;
+
+protected:
+    // Chamados fora do lock; write() so na thread do encoder.
+    virtual bool start(const std::string& outputFile, unsigned width, unsigned height,
+                       double fps, const std::string& preset) = 0;
+    virtual bool write(const std::vector<std::uint8_t>& frame) = 0;
+    virtual bool finish(bool aborted) = 0;
+    // Bytes gerados; por padrao o tamanho atual do arquivo de saida.
+    virtual size_t outputBytes() const;
+
+private:
+    void writerLoop();
+    bool stop(bool aborted);
+
+    size_t m_queueDepth;
+    bool m_open = false;
+    std::string m_file;
+    unsigned m_width = 0;
+    unsigned m_height = 0;
+    double m_fps = 0;
+    std::chrono::steady_clock::time_point m_started;
+    std::thread m_writer;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::vector<std::uint8_t>> m_queue;
+    std::vector<std::vector<std::uint8_t>> m_free;
+    size_t m_allocated = 0;
+    size_t m_written = 0;
+    bool m_closing = false;
+    bool m_failed = false;
+};
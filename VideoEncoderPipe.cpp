@@ -0,0 +1,87 @@
+#include "VideoEncoderPipe.h"
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <iostream>
+#include <pthread.h>
+#include <sstream>
+
+namespace {
+// SIGPIPE bloqueado so nesta thread e so enquanto escreve no pipe: se o
+// ffmpeg morrer, a escrita falha com EPIPE em vez de matar o processo, e o
+// sinal gerado por ela e consumido antes de restaurar a mascara. O resto do
+// processo mantem a disposicao de SIGPIPE que tinha.
+class SigpipeBlock {
+public:
+  SigpipeBlock() {
+    sigemptyset(&m_set);
+    sigaddset(&m_set, SIGPIPE);
+    sigset_t pending;
+    sigemptyset(&pending);
+    sigpending(&pending);
+    m_wasPending = sigismember(&pending, SIGPIPE) == 1;
+    pthread_sigmask(SIG_BLOCK, &m_set, &m_old);
+  }
+  ~SigpipeBlock() {
+    if (!m_wasPending) {
+      const int saved = errno;
+      const timespec zero = {0, 0};
+      while (sigtimedwait(&m_set, nullptr, &zero) > 0) {
+      }
+      errno = saved;
+    }
+    pthread_sigmask(SIG_SETMASK, &m_old, nullptr);
+  }
+  SigpipeBlock(const SigpipeBlock &) = delete;
+  SigpipeBlock &operator=(const SigpipeBlock &) = delete;
+
+private:
+  sigset_t m_set;
+  sigset_t m_old;
+  bool m_wasPending = false;
+};
+} // namespace
+
+bool VideoEncoderPipe::start(const std::string &outputFile, unsigned width,
+                             unsigned height, double fps,
+                             const std::string &preset) {
+  std::ostringstream cmd;
+  cmd << "ffmpeg -y -hide_banner -loglevel error -f rawvideo -pix_fmt rgba"
+      << " -s " << width << 'x' << height << " -framerate " << fps
+      << " -i - -vf '" << EVEN_SIZE_FILTER << "' -c:v libx264 -preset "
+      << preset << " -pix_fmt yuv420p "
+      << '"' << outputFile << '"';
+  std::cout << "[VideoEncoderPipe] Executando: " << cmd.str() << '\n';
+  m_pipe = popen(cmd.str().c_str(), "w");
+  if (!m_pipe) {
+    std::cerr << "[VideoEncoderPipe] Falha ao abrir pipe para ffmpeg." << '\n';
+    return false;
+  }
+  return true;
+}
+
+bool VideoEncoderPipe::write(const std::vector<std::uint8_t> &frame) {
+  // Descarrega aqui dentro: o buffer do FILE nao pode sobrar para uma
+  // escrita fora do bloqueio.
+  const SigpipeBlock block;
+  if (std::fwrite(frame.data(), 1, frame.size(), m_pipe) == frame.size() &&
+      std::fflush(m_pipe) == 0)
+    return true;
+  std::cerr << "[VideoEncoderPipe] Escrita no ffmpeg falhou." << '\n';
+  return false;
+}
+
+bool VideoEncoderPipe::finish(bool aborted) {
+  // Cancelado: o ffmpeg ainda fecha o arquivo com o que recebeu.
+  int code = 0;
+  {
+    const SigpipeBlock block; // pclose descarrega o que restou no FILE
+    code = pclose(m_pipe);
+  }
+  m_pipe = nullptr;
+  if (code != 0 && !aborted) {
+    std::cerr << "[VideoEncoderPipe] ffmpeg retornou código " << code << '\n';
+    return false;
+  }
+  return code == 0;
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "VideoEncoder.h"
+#include <cstdio>
+
+// Envia frames RGBA crus para o stdin de um ffmpeg (-f rawvideo), sem PNG
+// intermediario. Usado quando o binario nao foi ligado a libavcodec.
+class VideoEncoderPipe : public VideoEncoder {
+public:
+    explicit VideoEncoderPipe(size_t queueDepth = 4) : VideoEncoder(queueDepth) {}
+    ~VideoEncoderPipe() override { close(); }
+
+protected:
+    bool start(const std::string& outputFile, unsigned width, unsigned height,
+               double fps, const std::string& preset) override;
+    bool write(const std::vector<std::uint8_t>& frame) override;
+    bool finish(bool aborted) override;
+
+private:
+    FILE* m_pipe = nullptr;
+};
@@ -1,10 +1,124 @@
 #include "Visualizer.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
+namespace {
+sf::Color heatColor(float t) {
+  static const sf::Color stops[] = {sf::Color(30, 60, 160),
+                                    sf::Color(0, 200, 220),
+                                    sf::Color(240, 220, 60),
+                                    sf::Color(220, 60, 40)};
+  t = std::clamp(t, 0.f, 1.f) * 3.f;
+  int k = std::min(2, static_cast<int>(t));
+  float f = t - static_cast<float>(k);
+  const sf::Color &a = stops[k];
+  const sf::Color &b = stops[k + 1];
+  auto mix = [f](sf::Uint8 x, sf::Uint8 y) {
+    return static_cast<sf::Uint8>(x + (y - x) * f);
+  };
+  return sf::Color(mix(a.r, b.r), mix(a.g, b.g), mix(a.b, b.b));
+}
+} // namespace
+
 void Visualizer::render(const std::vector<int> &state) {
   if (m_nodes.size() == state.size()) {
     for (size_t i = 0; i < state.size(); ++i)
       m_nodes[i].value = state[i];
+    markContentChanged();
+  }
+}
+
+void Visualizer::sync(const std::vector<int> &state) {
+  if (m_nodes.size() != state.size()) {
+    m_nodes.assign(state.size(), VisualNode{});
+    for (size_t i = 0; i < state.size(); ++i)
+      m_nodes[i].position = m_grid.positionForIndex(i);
+  }
+  for (size_t i = 0; i < state.size(); ++i)
+    m_nodes[i].value = state[i];
+  markContentChanged();
+}
+
+void Visualizer::setVisibleArea(const sf::FloatRect &area,
+                                float pixelsPerUnit) {
+  if (m_hasVisibleArea && area == m_visibleArea &&
+      pixelsPerUnit == m_pixelsPerUnit)
+    return;
+  m_visibleArea = area;
+  m_pixelsPerUnit = pixelsPerUnit;
+  m_hasVisibleArea = true;
+  markDirty();
+}
+
+Visualizer::IndexRange Visualizer::visibleRange(const GridLayout &grid) const {
+  if (!m_hasVisibleArea)
+    return {0, m_nodes.size()};
+  auto rows = grid.rowSpan(m_visibleArea.top - grid.rowHeight,
+                           m_visibleArea.top + m_visibleArea.height +
+                               grid.rowHeight,
+                           m_nodes.size());
+  return {std::min(m_nodes.size(), rows.first * grid.cols),
+          std::min(m_nodes.size(), rows.second * grid.cols)};
+}
+
+Visualizer::IndexRange Visualizer::drawRange() const {
+  if (!isIdle() && m_nodes.size() <= FULL_SCAN_LIMIT)
+    return {0, m_nodes.size()};
+  return visibleRange(m_grid);
+}
+
+bool Visualizer::isOnScreen(sf::Vector2f pos, sf::Vector2f size) const {
+  if (!m_hasVisibleArea)
+    return true;
+  const float pad = 4.f;
+  sf::FloatRect box(pos.x - pad, pos.y - pad, size.x + 2 * pad,
+                    size.y + 2 * pad);
+  return box.intersects(m_visibleArea);
+}
+
+void Visualizer::appendValueStrips(ShapeBatch &batch, float itemWidth) const {
+  if (m_nodes.empty() || m_grid.rowHeight <= 0.f)
+    return;
+  if (m_contentDirty) {
+    m_summary.rebuild(m_nodes);
+    m_contentDirty = false;
+  }
+
+  float rowPx = m_grid.rowHeight * m_pixelsPerUnit;
+  size_t bandRows = std::max<size_t>(
+      1, static_cast<size_t>(std::ceil(LOD_STRIP_PX / std::max(rowPx, 1e-6f))));
+  auto rows = m_grid.rowSpan(m_visibleArea.top,
+                             m_visibleArea.top + m_visibleArea.height,
+                             m_nodes.size());
+  if (!m_hasVisibleArea)
+    rows = {0, m_grid.rowCount(m_nodes.size())};
+
+  const size_t cols = m_grid.cols;
+  const float width = static_cast<float>(cols - 1) * m_grid.stride + itemWidth;
+  const float range =
+      static_cast<float>(m_summary.maxValue() - m_summary.minValue());
+  // Alinha as faixas em multiplos de bandRows para nao "tremer" no pan.
+  for (size_t r = rows.first - rows.first % bandRows; r < rows.second;
+       r += bandRows) {
+    size_t first = r * cols;
+    size_t last = std::min(m_nodes.size(), (r + bandRows) * cols);
+    if (first >= last)
+      break;
+    float t = range > 0.f
+                  ? static_cast<float>(m_summary.mean(first, last) -
+                                       m_summary.minValue()) /
+                        range
+                  : 0.5f;
+    sf::Color color = heatColor(t);
+    float occupancy = static_cast<float>(last - first) /
+                      static_cast<float>(bandRows * cols);
+    color.a = static_cast<sf::Uint8>(80.f + 175.f * occupancy);
+    size_t bandEnd = std::min(r + bandRows, m_grid.rowCount(m_nodes.size()));
+    sf::Vector2f pos = m_grid.positionForIndex(first);
+    batch.addRect({m_grid.origin.x, pos.y},
+                  {width, static_cast<float>(bandEnd - r) * m_grid.rowHeight},
+                  color);
   }
 }
 
@@ -18,28 +132,22 @@ void Visualizer::highlight(size_t index) {
 }
 
 void Visualizer::exportFrames(const std::string &dirPath) {
-  if (m_recorder.enabled()) {
-    clearSavedFrames(dirPath);
-  }
   if (!m_recorder.save(dirPath)) {
     std::cerr << "[Visualizer] Falha ao exportar frames." << '\n';
   }
 }
 
-void Visualizer::exportFramesWithProgress(
-    const std::string &dirPath,
+bool Visualizer::exportFramesWithProgress(
+    const FrameSource &frames, const std::string &dirPath,
     const std::function<void(size_t, size_t)> &onProgress,
-    const std::function<bool()> &shouldCancel) {
-  if (m_recorder.enabled()) {
-    clearSavedFrames(dirPath);
-  }
-  if (!m_recorder.save(dirPath, "frame", onProgress, shouldCancel)) {
+    const std::function<bool()> &shouldCancel,
+    const WriteStatsFn &onWriteStats) {
+  if (!m_recorder.save(frames, dirPath, "frame", onProgress, shouldCancel,
+                       onWriteStats)) {
     std::cerr << "[Visualizer] Falha ao exportar frames." << '\n';
+    return false;
   }
-}
-
-void Visualizer::captureFrame(const sf::RenderWindow &window) {
-  m_recorder.capture(window);
+  return true;
 }
 
 void Visualizer::refreshPositions(
@@ -47,41 +155,61 @@ void Visualizer::refreshPositions(
   for (size_t i = 0; i < m_nodes.size(); ++i) {
     m_nodes[i].position = positionFn(i);
   }
+  markDirty();
 }
 
 bool Visualizer::saveFramesDAO(const std::string &dirPath) {
   return m_recorder.save(dirPath);
 }
 
-void Visualizer::exportAsMP4(const std::string &dirPath,
-                             const std::string &mp4File, int fps) {
-  if (m_recorder.enabled()) {
-    clearSavedFrames(dirPath);
-  }
-  if (!m_recorder.exportVideo(dirPath, mp4File, fps)) {
+bool Visualizer::exportAsMP4(
+    const FrameSource &frames, const std::string &mp4File, int fps,
+    const VideoProgressFn &onProgress,
+    const std::function<bool()> &shouldCancel) {
+  if (!m_recorder.exportVideo(frames, mp4File, fps, onProgress,
+                              shouldCancel)) {
     std::cerr << "[Visualizer] Falha ao gerar MP4." << '\n';
+    return false;
   }
+  return true;
 }
 
-void Visualizer::exportAsMP4WithProgress(
-    const std::string &dirPath, const std::string &mp4File, int fps,
-
-    const std::function<void(const std::string &)> &onProgress) {
-  if (m_recorder.enabled()) {
-    clearSavedFrames(dirPath);
+bool Visualizer::exportAnimation(
+    const FrameSource &frames, const std::string &file, int fps,
+    const std::function<void(size_t, size_t)> &onProgress,
+    const std::function<bool()> &shouldCancel) {
+  if (!m_recorder.exportAnimation(frames, file, fps, onProgress,
+                                  shouldCancel)) {
+    std::cerr << "[Visualizer] Falha ao gerar animacao." << '\n';
+    return false;
   }
-  if (!m_recorder.save(dirPath)) {
+  return true;
+}
+
+bool Visualizer::exportAsMP4WithProgress(
+    const FrameSource &frames, const std::string &dirPath,
+    const std::string &mp4File, int fps,
+    const std::function<void(size_t, size_t)> &onProgress,
+    const std::function<bool()> &shouldCancel,
+    const WriteStatsFn &onWriteStats) {
+  if (!m_recorder.save(frames, dirPath, "frame", onProgress, shouldCancel,
+                       onWriteStats)) {
     std::cerr << "[Visualizer] Falha ao salvar frames para MP4." << '\n';
-    return;
+    return false;
   }
-
   PersistenceDAO dao;
-  dao.exportMP4WithProgress(dirPath, mp4File, fps, onProgress);
+  return dao.exportMP4Segmented(dirPath, mp4File, fps, 0, onProgress,
+                                shouldCancel);
 }
 
-void Visualizer::clearMemoryFrames() {
-  m_recorder.clearMemory();
+bool Visualizer::clearMemoryFrames() {
+  if (!m_recorder.clearMemory()) {
+    std::cerr << "[Visualizer] Frames em uso por um export; nada limpo."
+              << '\n';
+    return false;
+  }
   std::cout << "[Visualizer] Frames em memória limpos." << '\n';
+  return true;
 }
 
 bool Visualizer::clearSavedFrames(const std::string &dirPath) {
@@ -1,46 +1,131 @@
 #pragma once
 #include "AnimationStrategy.h"
 #include "FrameRecorder.h"
+#include "LayoutPolicy.h"
+#include "ShapeBatch.h"
+#include "ValueSummary.h"
 #include "VisualizerBase.h"
 #include <SFML/Graphics.hpp>
 #include <vector>
 
 class Visualizer : public VisualizerBase {
 public:
+  void update(float dt) override {
+    VisualizerBase::update(dt);
+    m_recorder.advance(dt);
+  }
   void setStrategy(std::unique_ptr<AnimationStrategy> s) {
     m_strategy = std::move(s);
   }
   void render(const std::vector<int> &state);
+  // Recria os nos a partir do estado, sem animacao (estado inicial).
+  void sync(const std::vector<int> &state);
+  // Area do mundo visivel pela camera; usada para culling e nivel de detalhe.
+  void setVisibleArea(const sf::FloatRect &area, float pixelsPerUnit);
   void highlight(size_t index);
   void exportFrames(const std::string &dirPath);
-  void exportFramesWithProgress(
-      const std::string &dirPath,
+  // Os exports abaixo rodam fora da thread de desenho: recebem um
+  // recorder().snapshot() tirado quando o export foi pedido.
+  bool exportFramesWithProgress(
+      const FrameSource &frames, const std::string &dirPath,
       const std::function<void(size_t, size_t)> &onProgress,
-      const std::function<bool()> &shouldCancel = nullptr);
-  void exportAsMP4(const std::string &dirPath, const std::string &mp4File,
-                   int fps = 30);
-  void exportAsMP4WithProgress(
-      const std::string &dirPath, const std::string &mp4File, int fps,
-      const std::function<void(const std::string &)> &onProgress);
-  void captureFrame(const sf::RenderWindow &window);
+      const std::function<bool()> &shouldCancel = nullptr,
+      const WriteStatsFn &onWriteStats = nullptr);
+  // Frames direto no encoder, sem PNG intermediario.
+  bool exportAsMP4(const FrameSource &frames, const std::string &mp4File,
+                   int fps = 30, const VideoProgressFn &onProgress = nullptr,
+                   const std::function<bool()> &shouldCancel = nullptr);
+  // Salva em dirPath so os frames novos (manifesto) e codifica em trechos
+  // paralelos, reaproveitando os ja codificados; o progresso vem primeiro do
+  // save e depois da codificacao.
+  bool exportAsMP4WithProgress(
+      const FrameSource &frames, const std::string &dirPath,
+      const std::string &mp4File, int fps,
+      const std::function<void(size_t, size_t)> &onProgress = nullptr,
+      const std::function<bool()> &shouldCancel = nullptr,
+      const WriteStatsFn &onWriteStats = nullptr);
+  // Animacao (GIF/APNG/WebP pelo sufixo).
+  bool exportAnimation(const FrameSource &frames, const std::string &file,
+                       int fps = 30,
+                       const std::function<void(size_t, size_t)> &onProgress = nullptr,
+                       const std::function<bool()> &shouldCancel = nullptr);
+  // Inscrito num CaptureService, que faz a leitura da janela.
+  FrameRecorder &recorder() { return m_recorder; }
   void refreshPositions(std::function<sf::Vector2f(size_t)> positionFn);
   bool saveFramesDAO(const std::string &dirPath);
-  void clearMemoryFrames();
+  bool clearMemoryFrames();
   bool clearSavedFrames(const std::string &dirPath);
   void toggleCapture() { m_recorder.enable(!m_recorder.enabled()); }
+  void setCaptureEnabled(bool on) { m_recorder.enable(on); }
   bool isCaptureEnabled() const { return m_recorder.enabled(); }
-  void setCaptureMaxFrames(size_t maxFrames) {
-    m_recorder.setMaxFrames(maxFrames);
+  void setCaptureBudget(size_t bytes) { m_recorder.setMemoryBudget(bytes); }
+  void setCaptureRate(double fps) { m_recorder.setCaptureRate(fps); }
+  // Instant replay: captura ligada num anel com os ultimos `seconds`.
+  void setInstantReplay(bool on, double seconds = 30.0) {
+    m_recorder.setCircular(on);
+    m_recorder.setReplayWindow(on ? seconds : 0.0);
+    if (on)
+      m_recorder.enable(true);
   }
+  bool isInstantReplay() const { return m_recorder.isCircular(); }
+  void setCaptureScale(float scale) { m_recorder.setOutputScale(scale); }
   size_t getCapturedFrameCount() const { return m_recorder.count(); }
-  size_t getCaptureLimit() const { return m_recorder.maxFrames(); }
+  size_t getCaptureTickCount() const { return m_recorder.captureCount(); }
+  size_t getCaptureBudget() const { return m_recorder.memoryBudget(); }
+  size_t getCaptureMemoryUsed() const { return m_recorder.memoryUsed(); }
+  bool enableCaptureSpill(size_t diskBytes) { return m_recorder.enableSpill(diskBytes); }
+  size_t getCaptureSpilledBytes() const { return m_recorder.spilledBytes(); }
+  void setFrameFormat(const FrameWriterOptions &options) {
+    m_recorder.setFrameFormat(options);
+  }
   bool isIdle() const { return m_animationQueue.empty(); }
+  bool hasPendingWork() const {
+    return !m_animationQueue.empty() || !m_operationQueue.empty();
+  }
+  // Geometria mudou desde o ultimo draw (estado, animacao, layout ou camera).
+  bool needsRedraw() const { return m_dirty; }
+  size_t nodeCount() const { return m_nodes.size(); }
   void queueOperation(const std::string &description,
                       std::function<void()> action) {
     enqueueOperation(description, std::move(action));
   }
 
 protected:
+  struct IndexRange {
+    size_t first = 0;
+    size_t last = 0;
+    bool operator!=(const IndexRange &o) const {
+      return first != o.first || last != o.last;
+    }
+  };
+
+  // Indices cujas linhas da grade aparecem na area visivel (com uma linha
+  // de folga acima e abaixo).
+  IndexRange visibleRange(const GridLayout &grid) const;
+  // Indices a desenhar: durante animacoes pequenas os nos podem estar fora
+  // da grade, entao todos sao testados individualmente.
+  IndexRange drawRange() const;
+  bool isOnScreen(sf::Vector2f pos, sf::Vector2f size) const;
+  bool useValueStrips() const {
+    return m_grid.rowHeight * m_pixelsPerUnit < LOD_MIN_ROW_PX;
+  }
+  bool showLabels(float itemWidth) const {
+    return itemWidth * m_pixelsPerUnit >= LOD_MIN_LABEL_PX;
+  }
+  // Nivel de detalhe reduzido: faixas com a media dos valores por grupo de
+  // linhas, sem caixas individuais.
+  void appendValueStrips(ShapeBatch &batch, float itemWidth) const;
+
+  static constexpr float LOD_MIN_ROW_PX = 6.f;
+  static constexpr float LOD_MIN_LABEL_PX = 18.f;
+  static constexpr float LOD_STRIP_PX = 2.f;
+  static constexpr size_t FULL_SCAN_LIMIT = 4096;
+
   std::unique_ptr<AnimationStrategy> m_strategy = nullptr;
   FrameRecorder m_recorder;
+  GridLayout m_grid;
+  sf::FloatRect m_visibleArea;
+  bool m_hasVisibleArea = false;
+  float m_pixelsPerUnit = 1.f;
+  mutable ValueSummary m_summary;
 };
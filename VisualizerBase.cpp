@@ -4,9 +4,11 @@ void VisualizerBase::update(float dt) {
     if (m_animationQueue.empty() && !m_operationQueue.empty()) {
         m_operationQueue.front().action();
         m_operationQueue.pop_front();
+        markContentChanged();
     }
 
     if (!m_animationQueue.empty()) {
+        markContentChanged();
         if (m_animationQueue.front()->update(m_nodes, dt)) {
             m_animationQueue.pop_front();
         }
@@ -10,7 +10,7 @@ class IVisualizer {
 public:
     virtual ~IVisualizer() = default;
     virtual void update(float dt) = 0;
-    virtual void draw(sf::RenderWindow& window) const = 0;
+    virtual void draw(sf::RenderTarget& target) const = 0;
     virtual const std::deque<Command>& getOperationQueue() const = 0;
 };
 
@@ -22,13 +22,20 @@ public:
     void update(float dt) override;
     const std::deque<Command>& getOperationQueue() const override { return m_operationQueue; }
 
-    virtual void draw(sf::RenderWindow& window) const override = 0;
+    virtual void draw(sf::RenderTarget& target) const override = 0;
 
 protected:
     std::vector<VisualNode> m_nodes;
     std::deque<std::unique_ptr<AnimationStep>> m_animationQueue;
     std::deque<Command> m_operationQueue;
 
+    // Geometria em cache (vertex arrays) precisa ser reconstruida.
+    mutable bool m_dirty = true;
+    // Valores/quantidade dos nos mudaram (invalida resumos derivados).
+    mutable bool m_contentDirty = true;
+
+    void markDirty() { m_dirty = true; }
+    void markContentChanged() { m_dirty = true; m_contentDirty = true; }
     void enqueueAnimation(std::unique_ptr<AnimationStep> step) { m_animationQueue.push_back(std::move(step)); }
     void enqueueOperation(const std::string& description, std::function<void()> action) {
         m_operationQueue.push_back(Command{description, std::move(action)});
@@ -0,0 +1,57 @@
+#include "WorkerPool.h"
+
+size_t WorkerPool::defaultThreads() {
+  const unsigned n = std::thread::hardware_concurrency();
+  return n > 0 ? n : 2;
+}
+
+WorkerPool::WorkerPool(size_t threads) {
+  if (threads == 0)
+    threads = defaultThreads();
+  m_threads.reserve(threads);
+  for (size_t i = 0; i < threads; ++i)
+    m_threads.emplace_back(&WorkerPool::loop, this);
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  for (auto &t : m_threads)
+    t.join();
+}
+
+void WorkerPool::submit(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_tasks.push_back(std::move(task));
+  }
+  m_cv.notify_one();
+}
+
+void WorkerPool::waitIdle() {
+  std::unique_lock<std::mutex> lk(m_mutex);
+  m_idle.wait(lk, [this] { return m_tasks.empty() && m_running == 0; });
+}
+
+void WorkerPool::loop() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lk(m_mutex);
+      m_cv.wait(lk, [this] { return m_stop || !m_tasks.empty(); });
+      if (m_tasks.empty())
+        return;
+      task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+      ++m_running;
+    }
+    task();
+    std::lock_guard<std::mutex> lk(m_mutex);
+    --m_running;
+    if (m_tasks.empty() && m_running == 0)
+      m_idle.notify_all();
+  }
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool fixo de threads com fila de tarefas FIFO. Tarefas nao devem lancar.
+class WorkerPool {
+public:
+    // 0 = uma thread por nucleo.
+    explicit WorkerPool(size_t threads = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void submit(std::function<void()> task);
+    // Espera a fila esvaziar e todas as tarefas em execucao terminarem.
+    void waitIdle();
+    size_t size() const { return m_threads.size(); }
+
+    static size_t defaultThreads();
+
+private:
+    void loop();
+
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::condition_variable m_idle;
+    size_t m_running = 0;
+    bool m_stop = false;
+};
@@ -1,68 +1,27 @@
+#include "AnimationWriter.h"
+#include "Camera.h"
+#include "CaptureService.h"
 #include "Command.h"
+#include "CommandPanel.h"
 #include "CommandRecorder.h"
+#include "ExportScheduler.h"
+#include "FrameStats.h"
+#include "HeadlessRunner.h"
 #include "LinkedListVisualizer.h"
+#include "LiveVideoSink.h"
 #include "RandomProvider.h"
+#include "RenderLayer.h"
 #include "StructureController.h"
 #include "StructureFactory.h"
+#include "SubtitleRing.h"
 #include "VectorVisualizer.h"
 #include <SFML/Graphics.hpp>
-#include <atomic>
+#include <algorithm>
+#include <cstring>
 #include <ctime>
-#include <future>
 #include <iomanip>
 #include <iostream>
-#include <mutex>
 #include <sstream>
-#include <thread>
-
-void drawCommandPanel(sf::RenderWindow &window, sf::Font &font,
-                      const VectorVisualizer &vecViz,
-                      const LinkedListVisualizer &listViz) {
-
-  const float panelWidth = 280.f;
-  const float panelX = window.getSize().x - panelWidth;
-
-  sf::RectangleShape panel(sf::Vector2f(panelWidth, window.getSize().y));
-  panel.setPosition(panelX, 0);
-  panel.setFillColor(sf::Color(20, 20, 20, 200));
-  window.draw(panel);
-
-  sf::Text title("Fila de Comandos Pendentes", font, 20);
-  title.setFillColor(sf::Color::White);
-  title.setPosition(panelX + 15, 15);
-  window.draw(title);
-
-  const auto &vecQueue = vecViz.getOperationQueue();
-  const auto &listQueue = listViz.getOperationQueue();
-
-  std::vector<std::string> allCommands;
-  for (const auto &cmd : vecQueue)
-    allCommands.push_back(cmd.description);
-  for (const auto &cmd : listQueue)
-    allCommands.push_back(cmd.description);
-
-  sf::Text commandText("", font, 16);
-  commandText.setFillColor(sf::Color(220, 220, 220));
-  float currentY = 60.f;
-
-  if (allCommands.empty()) {
-    commandText.setString("(vazio)");
-    commandText.setPosition(panelX + 15, currentY);
-    window.draw(commandText);
-  } else {
-    for (const auto &desc : allCommands) {
-      commandText.setString(desc);
-      commandText.setPosition(panelX + 15, currentY);
-      window.draw(commandText);
-      currentY += 25.f;
-    }
-  }
-
-  sf::Text stats("Pendentes: " + std::to_string(allCommands.size()), font, 14);
-  stats.setFillColor(sf::Color(180, 180, 180));
-  stats.setPosition(panelX + 15, window.getSize().y - 30.f);
-  window.draw(stats);
-}
 
 static const std::vector<std::pair<std::string, std::string>> COMMAND_HELP = {
     {"I", "Inserir elemento aleatorio no Vetor"},
@@ -75,24 +34,57 @@ static const std::vector<std::pair<std::string, std::string>> COMMAND_HELP = {
     {"F", "Toggle capturar frames em memoria"},
     {"C", "Limpar frames em memoria"},
     {"X", "Limpar frames salvos em disco"},
-    {"E", "Exportar frames em PNG (frames/vector)"},
-    {"M", "Exportar MP4 (vector.mp4) via ffmpeg"},
+    {"E", "Exportar frames (frames/vector) no formato escolhido"},
+    {"U", "Formato dos frames: png / png-fast / qoi / raw"},
+    {"M", "Exportar MP4 (vector.mp4) da memoria direto no ffmpeg"},
+    {"Shift+M", "Exportar MP4 via frames/vector em trechos paralelos"},
+    {"Ctrl+M", "Exportar animacao (vector.gif/.apng/.webp) da memoria"},
+    {"Shift+U", "Formato da animacao: gif / apng / webp (se compilados)"},
+    {"Z", "Cancelar os exports em andamento"},
+    {"O", "Gravar video ao vivo direto no ffmpeg (live.mp4)"},
     {"G", "Iniciar/Parar gravacao de comandos"},
     {"S", "Salvar comandos gravados em texto (commands.log)"},
     {"L", "Carregar e executar replay imediato (commands.log)"},
     {"J", "Salvar comandos em JSON (commands.json)"},
     {"K", "Carregar JSON e iniciar replay temporal"},
+    {"Shift+J", "Salvar comandos no formato binario (commands.cmdlog)"},
+    {"Shift+K", "Carregar commands.cmdlog e iniciar replay temporal"},
     {"P", "Pausar/Retomar replay temporal"},
     {"N", "Avancar um passo no replay quando pausado"},
     {"[", "Diminuir velocidade do replay temporal"},
     {"]", "Aumentar velocidade do replay temporal"},
-    {"B", "(Futuro) Toggle modo circular de frames"},
-    {"T", "Toggle limite de frames (900 <-> 1800)"}};
+    {"Y", "Instant replay: liga anel dos ultimos 30 s / salva replay-*.mp4"},
+    {"Shift+Y", "Desliga o instant replay (volta a captura linear)"},
+    {"T", "Toggle memoria de captura (256 <-> 1024 MB)"},
+    {"Q", "Mostrar/ocultar tempo de frame"},
+    {"Setas", "Mover camera (ou arrastar com botao direito)"},
+    {"Roda", "Zoom da camera no cursor"},
+    {"Home", "Resetar camera"},
+    {"W", "Toggle render sob demanda (idle) / continuo"}};
+
+int main(int argc, char **argv) {
+  if (HeadlessRunner::isHeadless(argc, argv)) {
+    HeadlessOptions options;
+    if (!HeadlessRunner::parseArgs(argc, argv, options))
+      return 2;
+    return HeadlessRunner(options).run();
+  }
+
+  // --array N: painel do vetor usa um ArrayStructure com N elementos.
+  size_t arrayElements = 0;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--array") == 0 && i + 1 < argc)
+      arrayElements = std::strtoull(argv[++i], nullptr, 10);
+  }
 
-int main() {
   sf::RenderWindow window(sf::VideoMode(1400, 800),
                           "Visualizador Animado de Estruturas de Dados");
   window.setFramerateLimit(60);
+  sf::View hudView = window.getDefaultView();
+  Camera camera(window.getSize());
+  bool panningCamera = false;
+  sf::Vector2i lastMousePos;
+  sf::Vector2i lastHoverPos(-1, -1);
 
   sf::Font font;
   if (!font.loadFromFile("arial.ttf")) {
@@ -108,7 +100,9 @@ int main() {
   RandomProvider rng;
 
   StructureFactory factory;
-  auto arrayListStructure = factory.create("array_list");
+  auto arrayListStructure = arrayElements > 0
+                                ? factory.create("array", arrayElements * 2)
+                                : factory.create("array_list");
   auto linkedListStructure = factory.create("linked_list");
 
   StructureController controllerArray(std::move(arrayListStructure), &vecViz,
@@ -124,6 +118,7 @@ int main() {
   bool showLimitStatus = false;
   const std::string recordFile = "commands.log";
   const std::string recordJSON = "commands.json";
+  const std::string recordBinary = "commands.cmdlog";
 
   // Replay temporal
   bool timedReplayActive = false;
@@ -132,17 +127,35 @@ int main() {
   float timedReplaySpeed = 1.f;
   bool timedReplayPaused = false;
 
-  struct Subtitle {
-    std::string text;
-    float age;
-  };
-  std::vector<Subtitle> subtitles;
-  auto pushSubtitle = [&subtitles](const std::string &t) {
-    subtitles.push_back({t, 0.f});
-    if (subtitles.size() > 12)
-      subtitles.erase(subtitles.begin());
+  SubtitleRing subtitles(font);
+  auto pushSubtitle = [&subtitles](const std::string &t) { subtitles.push(t); };
+  CommandPanel commandPanel(font);
+
+  // Uma leitura da janela por frame, repartida entre os recorders: o vetor
+  // grava a janela inteira (export E/M) e a lista so o painel dela.
+  auto listPane = [&commandPanel](sf::Vector2u size) {
+    const int top = 380;
+    return sf::IntRect(0, top,
+                       static_cast<int>(size.x) -
+                           static_cast<int>(commandPanel.width()),
+                       static_cast<int>(size.y) - top);
   };
-  const float SUBTITLE_DURATION = 3.5f;
+  CaptureService captureService;
+  // Capturas longas: o limite (T) vira a janela em RAM e o resto transborda
+  // para um arquivo temporario mapeado em memoria.
+  if (!vecViz.enableCaptureSpill(size_t(8) << 30))
+    std::cerr << "[Frames] Spill em disco indisponivel; captura so em RAM\n";
+  // Captura no ritmo do video exportado (M), nao no da janela.
+  constexpr int CAPTURE_FPS = 30;
+  vecViz.setCaptureRate(CAPTURE_FPS);
+  listViz.setCaptureRate(CAPTURE_FPS);
+  captureService.subscribe(vecViz.recorder());
+  const auto listPaneCapture =
+      captureService.subscribe(listViz.recorder(), listPane(window.getSize()));
+  LiveVideoSink liveVideo;
+  size_t frameFormatIndex = 0; // tecla U
+  std::string animationFormat = "gif"; // Shift+U
+  captureService.subscribe(liveVideo);
 
   sf::RectangleShape helpButton(sf::Vector2f(110.f, 30.f));
   helpButton.setFillColor(sf::Color(60, 60, 140));
@@ -152,25 +165,68 @@ int main() {
   bool showHelpWindow = false;
   std::unique_ptr<sf::RenderWindow> helpWindow;
 
-  bool exportingFrames = false;
-  std::atomic<size_t> framesProgressCurrent{0};
-  std::atomic<size_t> framesProgressTotal{0};
-  sf::Clock exportClock;
-  bool videoCancelRequested = false;
-  bool framesCancelRequested = false;
-  pid_t currentVideoPid = -1;
-  bool exportingVideo = false;
-  std::future<bool> exportFutureFrames;
-  std::atomic<bool> videoDone{false};
-  std::mutex videoProgressMutex;
-  std::string videoProgressLine;
+  // Exports em threads do scheduler; o termino chega por poll() no loop.
+  // Declarado depois dos visualizers: o destrutor cancela e espera os jobs.
+  ExportScheduler exports;
+  constexpr double REPLAY_SECONDS = 30.0; // tecla Y
+  // Progresso de video/replay no formato do scheduler.
+  auto videoProgress = [](ExportJob &job) {
+    return [&job](const VideoExportProgress &p) {
+      ExportProgress &out = job.progress();
+      out.set(p.frame, p.total);
+      out.bytes = p.encoder.bytes;
+      out.fps = p.encoder.framesPerSecond();
+      out.speed = p.encoder.speed();
+    };
+  };
+  auto countProgress = [](ExportJob &job) {
+    return [&job](size_t cur, size_t total) { job.progress().set(cur, total); };
+  };
+  auto writeStats = [](ExportJob &job) {
+    return [&job](const FileWriteStats &s) {
+      ExportProgress &out = job.progress();
+      out.bytes = s.bytes;
+      out.throughput = s.bytesPerSecond();
+      out.queueDepth = s.queued;
+    };
+  };
+
+  FrameStats frameStats;
+  bool showFrameStats = false;
+
+  // Render sob demanda: sem animacao/export/replay/captura, a janela bloqueia
+  // em waitEvent e so redesenha quando algo muda. Fundo, estruturas e painel
+  // ficam em camadas cacheadas e sao recompostos sem redesenhar.
+  bool renderOnChange = true;
+  bool needsRedraw = true;
+  RenderLayer backgroundLayer;
+  RenderLayer structuresLayer;
+  RenderLayer panelLayer;
+  auto isBusy = [&]() {
+    return vecViz.hasPendingWork() || listViz.hasPendingWork() ||
+           timedReplayActive || exports.busy() ||
+           !subtitles.empty() || vecViz.isCaptureEnabled() ||
+           listViz.isCaptureEnabled() || liveVideo.capturing() ||
+           showHelpWindow || showFrameStats ||
+           panningCamera;
+  };
 
   while (window.isOpen()) {
+    sf::Event event;
+    bool waited = false;
+    if (renderOnChange && !needsRedraw && !isBusy()) {
+      waited = window.waitEvent(event);
+      clock.restart(); // tempo ocioso nao conta como dt de animacao
+    }
+
     sf::Time elapsed = clock.restart();
     float dt = elapsed.asSeconds();
 
-    sf::Event event;
-    while (window.pollEvent(event)) {
+    for (bool pending = waited; pending || window.pollEvent(event);
+         pending = false) {
+      if (event.type != sf::Event::MouseMoved)
+        needsRedraw = true;
+
       if (event.type == sf::Event::Closed) {
         window.close();
       }
@@ -178,18 +234,57 @@ int main() {
       if (event.type == sf::Event::Resized) {
         sf::FloatRect visibleArea(0.f, 0.f, event.size.width,
                                   event.size.height);
-        window.setView(sf::View(visibleArea));
+        hudView = sf::View(visibleArea);
+        window.setView(hudView);
+        camera.resize(window.getSize());
+        captureService.setRegion(listPaneCapture, listPane(window.getSize()));
+        backgroundLayer.invalidate();
+        structuresLayer.invalidate();
+        panelLayer.invalidate();
+      }
+
+      if (event.type == sf::Event::MouseWheelScrolled &&
+          event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel) {
+        float factor = event.mouseWheelScroll.delta > 0 ? 0.8f : 1.25f;
+        camera.zoomAt({event.mouseWheelScroll.x, event.mouseWheelScroll.y},
+                      factor, window);
+      }
+
+      if (event.type == sf::Event::MouseButtonPressed &&
+          event.mouseButton.button == sf::Mouse::Right) {
+        panningCamera = true;
+        lastMousePos = {event.mouseButton.x, event.mouseButton.y};
+      }
+      if (event.type == sf::Event::MouseButtonReleased &&
+          event.mouseButton.button == sf::Mouse::Right) {
+        panningCamera = false;
       }
 
       if (event.type == sf::Event::MouseMoved) {
+        if (panningCamera) {
+          sf::Vector2i cur(event.mouseMove.x, event.mouseMove.y);
+          camera.pan(sf::Vector2f(lastMousePos - cur));
+          lastMousePos = cur;
+          needsRedraw = true;
+        }
+        sf::Vector2f oldButtonPos = helpButton.getPosition();
+        bool wasHover = helpButton.getGlobalBounds().contains(
+            static_cast<float>(lastHoverPos.x),
+            static_cast<float>(lastHoverPos.y));
         helpButton.setPosition(15.f, 100.f);
-        if (helpButton.getGlobalBounds().contains(
-                static_cast<float>(event.mouseMove.x),
-                static_cast<float>(event.mouseMove.y))) {
+        lastHoverPos = {event.mouseMove.x, event.mouseMove.y};
+        bool hover = helpButton.getGlobalBounds().contains(
+            static_cast<float>(event.mouseMove.x),
+            static_cast<float>(event.mouseMove.y));
+        if (hover) {
           helpButton.setFillColor(sf::Color(80, 80, 180));
         } else {
           helpButton.setFillColor(sf::Color(60, 60, 140));
         }
+        if (hover != wasHover || oldButtonPos != helpButton.getPosition()) {
+          backgroundLayer.invalidate();
+          needsRedraw = true;
+        }
       }
 
       if (event.type == sf::Event::MouseButtonPressed &&
@@ -228,161 +323,139 @@ int main() {
         else if (event.key.code == sf::Keyboard::B)
           controllerList.executeAndRecord("clear", &recorder, "list");
         else if (event.key.code == sf::Keyboard::E) {
-          if (!exportingFrames) {
-            exportingFrames = true;
-            framesProgressCurrent = 0;
-            framesProgressTotal = vecViz.getCapturedFrameCount();
+          if (!exports.active(ExportKind::Frames)) {
             pushSubtitle("Export PNG iniciada");
-            exportFutureFrames =
-                std::async(std::launch::async, [&vecViz, &framesProgressCurrent,
-                                                &framesProgressTotal,
-                                                &framesCancelRequested]() {
-                  vecViz.exportFramesWithProgress(
-                      "frames/vector",
-                      [&framesProgressCurrent,
-                       &framesProgressTotal](size_t cur, size_t total) {
-                        framesProgressCurrent = cur;
-
-                        framesProgressTotal = total;
-                      },
-                      [&framesCancelRequested]() {
-                        return framesCancelRequested;
-                      });
-
-                  return true;
-                });
+            // Fixa os frames de agora; a captura continua no store.
+            std::shared_ptr<const FrameSource> snapshot =
+                vecViz.recorder().snapshot();
+            exports.submit(
+                ExportKind::Frames, "Frames",
+                [&vecViz, countProgress, writeStats, snapshot](ExportJob &job) {
+                  return vecViz.exportFramesWithProgress(
+                      *snapshot, "frames/vector", countProgress(job),
+                      job.cancelToken(), writeStats(job));
+                },
+                [&pushSubtitle](const ExportJob &job) {
+                  pushSubtitle(job.state() == ExportState::Cancelled
+                                   ? "Export PNG cancelada em " +
+                                         std::to_string(job.progress().current) +
+                                         " frames"
+                               : job.state() == ExportState::Done
+                                   ? "Export PNG concluida"
+                                   : "Falha no export PNG");
+                },
+                ExportPriority::Low);
           }
         } else if (event.key.code == sf::Keyboard::M) {
-          if (!exportingVideo) {
-            exportingVideo = true;
-            videoDone = false;
-            videoProgressLine.clear();
-            videoCancelRequested = false;
-            exportClock.restart();
-            pushSubtitle("Export MP4 iniciada");
-            std::thread([&vecViz, &videoDone, &videoProgressLine,
-                         &videoProgressMutex, &currentVideoPid]() {
-              const int fpsLocal = 30;
-              size_t totalFrames = vecViz.getCapturedFrameCount();
-
-              if (totalFrames == 0)
-                totalFrames = vecViz.getCaptureLimit();
-
-              std::atomic<int> curFrame{-1};
-              std::atomic<long long> outTimeMs{-1};
-              std::atomic<bool> finished{false};
-
-              PersistenceDAO dao;
-              dao.exportMP4WithProgressCancelable(
-                  "frames/vector", "vector.mp4", fpsLocal, currentVideoPid,
-                  [&videoDone, &videoProgressLine, &videoProgressMutex,
-                   &curFrame, &outTimeMs, &finished,
-                   totalFrames](const std::string &raw) {
-                    if (raw == "progress=end") {
-                      finished = true;
-                      videoDone = true;
-                      return;
-                    }
-
-                    auto eqPos = raw.find('=');
-                    if (eqPos == std::string::npos)
-                      return;
-
-                    std::string key = raw.substr(0, eqPos);
-                    std::string val = raw.substr(eqPos + 1);
-
-                    if (key == "frame") {
-                      try {
-                        curFrame = std::stoi(val);
-                      } catch (...) {
-                      }
-                    } else if (key == "out_time_ms") {
-                      try {
-                        outTimeMs = std::stoll(val);
-                      } catch (...) {
-                      }
-                    }
-
-                    if (curFrame.load() >= 0) {
-                      double pct = (totalFrames > 0)
-                                       ? (double)curFrame.load() /
-                                             (double)totalFrames * 100.0
-                                       : 0.0;
-                      double etaSec = 0.0;
-                      if (totalFrames > 0 && curFrame.load() >= 0) {
-                        double remainingFrames =
-                            (double)totalFrames - curFrame.load();
-                        etaSec = remainingFrames / fpsLocal;
-                      }
-
-                      int etaInt = (int)etaSec;
-                      int etaM = etaInt / 60;
-                      int etaS = etaInt % 60;
-
-                      double curTimeSec =
-                          (outTimeMs.load() >= 0)
-                              ? (double)outTimeMs.load() / 1000000.0
-                              : -1.0;
-                      char buf[160];
-                      if (curTimeSec >= 0) {
-                        double totalExpectedSec =
-                            (totalFrames > 0) ? (double)totalFrames / fpsLocal
-                                              : 0.0;
-                        double pctTime =
-                            (totalExpectedSec > 0)
-                                ? curTimeSec / totalExpectedSec * 100.0
-                                : 0.0;
-                        snprintf(buf, sizeof(buf),
-                                 "frame %d/%zu (%.1f%%) time %.2fs (%.1f%%) "
-                                 "ETA %02d:%02d",
-                                 curFrame.load(), totalFrames, pct, curTimeSec,
-                                 pctTime, etaM, etaS);
-                      } else {
-                        snprintf(buf, sizeof(buf),
-                                 "frame %d/%zu (%.1f%%) ETA %02d:%02d",
-                                 curFrame.load(), totalFrames, pct, etaM, etaS);
-                      }
-
-                      std::lock_guard<std::mutex> lk(videoProgressMutex);
-                      videoProgressLine = buf;
-                    } else {
-                      std::lock_guard<std::mutex> lk(videoProgressMutex);
-                      videoProgressLine = raw;
-                    }
-                  });
-              videoDone = true;
-            }).detach();
+          auto finished = [&pushSubtitle](const ExportJob &job) {
+            pushSubtitle(job.state() == ExportState::Cancelled
+                             ? "Export cancelada: " + job.label()
+                         : job.state() == ExportState::Done
+                             ? "Export concluida: " + job.label()
+                             : "Falha no export: " + job.label());
+          };
+          if (event.key.control) {
+            if (!exports.active(ExportKind::Animation)) {
+              const std::string file = "vector." + animationFormat;
+              pushSubtitle("Export " + file + " iniciada");
+              std::shared_ptr<const FrameSource> snapshot =
+                  vecViz.recorder().snapshot();
+              exports.submit(
+                  ExportKind::Animation, file,
+                  [&vecViz, countProgress, file, snapshot](ExportJob &job) {
+                    return vecViz.exportAnimation(*snapshot, file, CAPTURE_FPS,
+                                                  countProgress(job),
+                                                  job.cancelToken());
+                  },
+                  finished);
+            }
+          } else if (!exports.active(ExportKind::Video)) {
+            std::shared_ptr<const FrameSource> snapshot =
+                vecViz.recorder().snapshot();
+            if (event.key.shift) {
+              pushSubtitle("Export MP4 em trechos iniciada");
+              // Salva no formato escolhido (U) e codifica um trecho por nucleo.
+              exports.submit(ExportKind::Video, "vector.mp4 (trechos)",
+                             [&vecViz, countProgress, writeStats,
+                              snapshot](ExportJob &job) {
+                               return vecViz.exportAsMP4WithProgress(
+                                   *snapshot, "frames/vector", "vector.mp4",
+                                   CAPTURE_FPS, countProgress(job),
+                                   job.cancelToken(), writeStats(job));
+                             },
+                             finished);
+            } else {
+              pushSubtitle("Export MP4 iniciada");
+              // Frames da memoria direto no encoder, sem PNGs.
+              exports.submit(ExportKind::Video, "vector.mp4",
+                             [&vecViz, videoProgress,
+                              snapshot](ExportJob &job) {
+                               return vecViz.exportAsMP4(
+                                   *snapshot, "vector.mp4", CAPTURE_FPS,
+                                   videoProgress(job), job.cancelToken());
+                             },
+                             finished);
+            }
           }
         } else if (event.key.code == sf::Keyboard::Z) {
-          if (exportingVideo && !videoDone && currentVideoPid > 0) {
-            if (PersistenceDAO::cancelProcess(currentVideoPid)) {
-              pushSubtitle("Video cancelado");
-              videoCancelRequested = true;
-            } else {
-              pushSubtitle("Falha cancelar video");
+          if (exports.busy()) {
+            exports.cancelAll();
+            pushSubtitle("Exports cancelados (parar apos frame atual)");
+          }
+        } else if (event.key.code == sf::Keyboard::U && event.key.shift) {
+          // Proximo formato compilado (APNG pede zlib, WebP pede libwebp).
+          static const char *animFormats[] = {"gif", "apng", "webp"};
+          size_t current = 0;
+          while (animationFormat != animFormats[current])
+            ++current;
+          for (size_t step = 1; step <= 3; ++step) {
+            const char *next = animFormats[(current + step) % 3];
+            if (AnimationWriter::supported(std::string("x.") + next)) {
+              animationFormat = next;
+              break;
             }
           }
-
-          if (exportingFrames) {
-            framesCancelRequested = true;
-            pushSubtitle("Frames cancelados (parar apos atual)");
+          pushSubtitle("Formato animacao: " + animationFormat);
+        } else if (event.key.code == sf::Keyboard::U) {
+          static const char *formats[] = {"png", "png-fast", "qoi", "raw"};
+          frameFormatIndex = (frameFormatIndex + 1) % 4;
+          FrameWriterOptions options;
+          FrameWriterOptions::parse(formats[frameFormatIndex], options);
+          vecViz.setFrameFormat(options);
+          pushSubtitle(std::string("Formato frames: ") +
+                       formats[frameFormatIndex]);
+        } else if (event.key.code == sf::Keyboard::O) {
+          if (liveVideo.capturing()) {
+            pushSubtitle(liveVideo.stop() ? "Video ao vivo salvo (live.mp4)"
+                                          : "Falha no video ao vivo");
+          } else if (liveVideo.start("live.mp4", window.getSize().x,
+                                     window.getSize().y, 60.0)) {
+            pushSubtitle("Gravando video ao vivo");
+          } else {
+            pushSubtitle("Falha ao iniciar ffmpeg");
           }
         } else if (event.key.code == sf::Keyboard::F) {
           vecViz.toggleCapture();
           pushSubtitle(vecViz.isCaptureEnabled() ? "Captura ON"
                                                  : "Captura OFF");
         } else if (event.key.code == sf::Keyboard::C) {
-          vecViz.clearMemoryFrames();
-          pushSubtitle("Frames memoria limpos");
+          // Exports em andamento leem um snapshot destes frames.
+          pushSubtitle(vecViz.clearMemoryFrames()
+                           ? "Frames memoria limpos"
+                           : "Export em andamento: cancele (Z) antes de limpar");
         } else if (event.key.code == sf::Keyboard::X) {
-          vecViz.clearSavedFrames("frames/vector");
-          pushSubtitle("Frames disco limpos");
+          // E e Shift+M gravam em frames/vector.
+          if (exports.active(ExportKind::Frames) ||
+              exports.active(ExportKind::Video)) {
+            pushSubtitle("Export em andamento: cancele (Z) antes de limpar");
+          } else {
+            vecViz.clearSavedFrames("frames/vector");
+            pushSubtitle("Frames disco limpos");
+          }
         } else if (event.key.code == sf::Keyboard::G) {
           bool wasRecording = recorder.isRecording();
           recorder.toggle();
           if (!wasRecording && recorder.isRecording()) {
-            framesCancelRequested = false;
-            exportClock.restart();
             if (!rng.hasSeed())
               rng.setSeed(recorder.seed());
             pushSubtitle("Seed=" + std::to_string(recorder.seed()));
@@ -397,20 +470,10 @@ int main() {
             std::cout << "[Recorder] Replay imediato iniciando...\n";
             for (const auto &cmd : recorder.get()) {
               if (cmd.target == "vector") {
-                if (cmd.op == "INSERT" && cmd.hasValue)
-                  controllerArray.insertAt(cmd.index, cmd.value);
-                else if (cmd.op == "REMOVE")
-                  controllerArray.removeAt(cmd.index);
-                else if (cmd.op == "HIGHLIGHT")
-                  controllerArray.highlightAt(cmd.index);
+                controllerArray.replay(cmd);
                 pushSubtitle("Replay:" + cmd.op + " vector");
               } else if (cmd.target == "list") {
-                if (cmd.op == "INSERT" && cmd.hasValue)
-                  controllerList.insertAt(cmd.index, cmd.value);
-                else if (cmd.op == "REMOVE")
-                  controllerList.removeAt(cmd.index);
-                else if (cmd.op == "HIGHLIGHT")
-                  controllerList.highlightAt(cmd.index);
+                controllerList.replay(cmd);
                 pushSubtitle("Replay:" + cmd.op + " list");
               }
             }
@@ -418,12 +481,22 @@ int main() {
             pushSubtitle("Replay imediato fim");
           }
         } else if (event.key.code == sf::Keyboard::J) {
-          if (recorder.saveJSON(recordJSON))
-            std::cout << "[Recorder] JSON salvo em " << recordJSON << "\n";
-          pushSubtitle("Salvar JSON");
+          if (event.key.shift) {
+            if (recorder.saveBinary(recordBinary))
+              std::cout << "[Recorder] Log binario salvo em " << recordBinary
+                        << "\n";
+            pushSubtitle("Salvar CMDLOG");
+          } else {
+            if (recorder.saveJSON(recordJSON))
+              std::cout << "[Recorder] JSON salvo em " << recordJSON << "\n";
+            pushSubtitle("Salvar JSON");
+          }
         } else if (event.key.code == sf::Keyboard::K) {
-          if (recorder.loadJSON(recordJSON)) {
-            std::cout << "[Recorder] Replay temporal carregado de JSON...\n";
+          const bool binary = event.key.shift;
+          if (binary ? recorder.loadBinary(recordBinary)
+                     : recorder.loadJSON(recordJSON)) {
+            std::cout << "[Recorder] Replay temporal carregado de "
+                      << (binary ? recordBinary : recordJSON) << "...\n";
             if (recorder.seed() &&
                 (!rng.hasSeed() || rng.seed() != recorder.seed())) {
               rng.setSeed(recorder.seed());
@@ -456,20 +529,64 @@ int main() {
           timedReplaySpeed = std::min(16.f, timedReplaySpeed * 2.f);
           std::cout << "[Replay] speed=" << timedReplaySpeed << '\n';
           pushSubtitle("Replay speed=" + std::to_string(timedReplaySpeed));
-        } else if (event.key.code == sf::Keyboard::B) {
-          vecViz.toggleCapture();
-          std::cout << "[Frames] Modo circular requer implementacao completa "
-                       "(placeholder)."
-                    << '\n';
-          pushSubtitle("Modo circular placeholder");
+        } else if (event.key.code == sf::Keyboard::Y) {
+          if (event.key.shift) {
+            vecViz.setInstantReplay(false);
+            pushSubtitle("Instant replay OFF");
+          } else if (!vecViz.isInstantReplay()) {
+            vecViz.setInstantReplay(true, REPLAY_SECONDS);
+            pushSubtitle("Instant replay ON (ultimos " +
+                         std::to_string(static_cast<int>(REPLAY_SECONDS)) +
+                         " s)");
+          } else if (!exports.active(ExportKind::Replay)) {
+            // A faixa e fixada agora; a captura segue enquanto o video sai.
+            std::shared_ptr<const FrameSource> snapshot =
+                vecViz.recorder().snapshot(REPLAY_SECONDS);
+            char name[64];
+            const std::time_t now = std::time(nullptr);
+            std::strftime(name, sizeof(name), "replay-%Y%m%d-%H%M%S.mp4",
+                          std::localtime(&now));
+            const std::string file = name;
+            pushSubtitle("Salvando " + file);
+            exports.submit(
+                ExportKind::Replay, file,
+                [&vecViz, videoProgress, file, snapshot](ExportJob &job) {
+                  return vecViz.recorder().exportVideo(
+                      *snapshot, file, CAPTURE_FPS, videoProgress(job),
+                      job.cancelToken());
+                },
+                [&pushSubtitle](const ExportJob &job) {
+                  pushSubtitle(job.state() == ExportState::Done
+                                   ? "Replay salvo: " + job.label()
+                                   : "Falha ao salvar replay");
+                },
+                ExportPriority::High);
+          }
         } else if (event.key.code == sf::Keyboard::T) {
-          size_t currentLimit = vecViz.getCaptureLimit();
-          size_t newLimit = (currentLimit <= 900) ? 1800 : 900;
-          vecViz.setCaptureMaxFrames(newLimit);
-          std::cout << "[Frames] Limite de captura agora = " << newLimit
-                    << " frames." << '\n';
+          const size_t currentMB = vecViz.getCaptureBudget() >> 20;
+          const size_t newMB = (currentMB <= 256) ? 1024 : 256;
+          vecViz.setCaptureBudget(newMB << 20);
+          std::cout << "[Frames] Memoria de captura agora = " << newMB
+                    << " MB." << '\n';
           showLimitStatus = true;
-          pushSubtitle("Limite=" + std::to_string(newLimit));
+          pushSubtitle("Limite=" + std::to_string(newMB) + " MB");
+        } else if (event.key.code == sf::Keyboard::Left) {
+          camera.pan({-80.f, 0.f});
+        } else if (event.key.code == sf::Keyboard::Right) {
+          camera.pan({80.f, 0.f});
+        } else if (event.key.code == sf::Keyboard::Up) {
+          camera.pan({0.f, -80.f});
+        } else if (event.key.code == sf::Keyboard::Down) {
+          camera.pan({0.f, 80.f});
+        } else if (event.key.code == sf::Keyboard::Home) {
+          camera.reset();
+        } else if (event.key.code == sf::Keyboard::W) {
+          renderOnChange = !renderOnChange;
+          pushSubtitle(renderOnChange ? "Render sob demanda"
+                                      : "Render continuo");
+        } else if (event.key.code == sf::Keyboard::Q) {
+          showFrameStats = !showFrameStats;
+          pushSubtitle(showFrameStats ? "Frame time ON" : "Frame time OFF");
         }
       }
     }
@@ -477,26 +594,7 @@ int main() {
     vecViz.update(dt);
     listViz.update(dt);
 
-    if (exportingFrames && exportFutureFrames.valid() &&
-        exportFutureFrames.wait_for(std::chrono::milliseconds(0)) ==
-            std::future_status::ready) {
-      if (framesCancelRequested) {
-        pushSubtitle("Export PNG cancelada em " +
-                     std::to_string(framesProgressCurrent.load()) + " frames");
-      } else {
-        pushSubtitle("Export PNG concluida");
-      }
-      exportingFrames = false;
-    }
-
-    if (exportingVideo && videoDone.load()) {
-      if (videoCancelRequested) {
-        pushSubtitle("Export MP4 cancelada");
-      } else {
-        pushSubtitle("Export MP4 concluida");
-      }
-      exportingVideo = false;
-    }
+    exports.poll();
 
     if (timedReplayActive) {
       if (!timedReplayPaused)
@@ -506,20 +604,10 @@ int main() {
              cmds[timedReplayIndex].t <= timedReplayClock) {
         const auto &cmd = cmds[timedReplayIndex];
         if (cmd.target == "vector") {
-          if (cmd.op == "INSERT" && cmd.hasValue)
-            controllerArray.insertAt(cmd.index, cmd.value);
-          else if (cmd.op == "REMOVE")
-            controllerArray.removeAt(cmd.index);
-          else if (cmd.op == "HIGHLIGHT")
-            controllerArray.highlightAt(cmd.index);
+          controllerArray.replay(cmd);
           pushSubtitle("Temporal:" + cmd.op + " vector");
         } else if (cmd.target == "list") {
-          if (cmd.op == "INSERT" && cmd.hasValue)
-            controllerList.insertAt(cmd.index, cmd.value);
-          else if (cmd.op == "REMOVE")
-            controllerList.removeAt(cmd.index);
-          else if (cmd.op == "HIGHLIGHT")
-            controllerList.highlightAt(cmd.index);
+          controllerList.replay(cmd);
           pushSubtitle("Temporal:" + cmd.op + " list");
         }
         timedReplayIndex++;
@@ -531,43 +619,91 @@ int main() {
       }
     }
 
-    window.clear(sf::Color(30, 30, 30));
-
-    titleText.setPosition(window.getSize().x / 2.0f, 30.f);
-
-    std::string instructionsString =
-        "[I] Inserir no Vetor  |  [R] Remover do Vetor\n"
-        "[A] Adicionar na Lista  |  [D] Remover da Lista";
-    instructionsText.setFont(font);
-    instructionsText.setString(instructionsString);
-    instructionsText.setCharacterSize(16);
-    instructionsText.setFillColor(sf::Color(200, 200, 200));
-    sf::FloatRect instructionsBounds = instructionsText.getLocalBounds();
-    instructionsText.setOrigin(
-        instructionsBounds.left + instructionsBounds.width / 2.0f,
-        instructionsBounds.top + instructionsBounds.height / 2.0f);
-    instructionsText.setPosition(window.getSize().x / 2.0f, 70.f);
-
-    window.draw(titleText);
-    window.draw(instructionsText);
-
-    window.draw(helpButton);
-    sf::Text helpButtonText("Ajuda", font, 16);
-    helpButtonText.setFillColor(sf::Color::White);
-    sf::FloatRect hb = helpButtonText.getLocalBounds();
-    helpButtonText.setOrigin(hb.left + hb.width / 2.f,
-                             hb.top + hb.height / 2.f);
-    helpButtonText.setPosition(
-        helpButton.getPosition().x + helpButton.getSize().x / 2.f,
-        helpButton.getPosition().y + helpButton.getSize().y / 2.f - 2.f);
-    window.draw(helpButtonText);
-
-    vecViz.reflow(static_cast<float>(window.getSize().x));
-    listViz.reflow(static_cast<float>(window.getSize().x));
-    vecViz.draw(window);
-    listViz.draw(window);
-
-    drawCommandPanel(window, font, vecViz, listViz);
+    if (!renderOnChange || isBusy() || vecViz.needsRedraw() ||
+        listViz.needsRedraw())
+      needsRedraw = true;
+    if (!needsRedraw)
+      continue;
+    needsRedraw = false;
+
+    frameStats.begin();
+    sf::Vector2u windowSize = window.getSize();
+    bool layered = backgroundLayer.resize(windowSize) &&
+                   structuresLayer.resize(windowSize) &&
+                   panelLayer.resize(windowSize);
+
+    auto drawBackground = [&](sf::RenderTarget &target) {
+      titleText.setPosition(windowSize.x / 2.0f, 30.f);
+
+      std::string instructionsString =
+          "[I] Inserir no Vetor  |  [R] Remover do Vetor\n"
+          "[A] Adicionar na Lista  |  [D] Remover da Lista";
+      instructionsText.setFont(font);
+      instructionsText.setString(instructionsString);
+      instructionsText.setCharacterSize(16);
+      instructionsText.setFillColor(sf::Color(200, 200, 200));
+      sf::FloatRect instructionsBounds = instructionsText.getLocalBounds();
+      instructionsText.setOrigin(
+          instructionsBounds.left + instructionsBounds.width / 2.0f,
+          instructionsBounds.top + instructionsBounds.height / 2.0f);
+      instructionsText.setPosition(windowSize.x / 2.0f, 70.f);
+
+      target.draw(titleText);
+      target.draw(instructionsText);
+
+      target.draw(helpButton);
+      sf::Text helpButtonText("Ajuda", font, 16);
+      helpButtonText.setFillColor(sf::Color::White);
+      sf::FloatRect hb = helpButtonText.getLocalBounds();
+      helpButtonText.setOrigin(hb.left + hb.width / 2.f,
+                               hb.top + hb.height / 2.f);
+      helpButtonText.setPosition(
+          helpButton.getPosition().x + helpButton.getSize().x / 2.f,
+          helpButton.getPosition().y + helpButton.getSize().y / 2.f - 2.f);
+      target.draw(helpButtonText);
+    };
+
+    auto drawStructures = [&](sf::RenderTarget &target) {
+      target.setView(camera.view());
+      vecViz.draw(target);
+      listViz.draw(target);
+    };
+
+    vecViz.setVisibleArea(camera.visibleArea(), camera.pixelsPerUnit());
+    listViz.setVisibleArea(camera.visibleArea(), camera.pixelsPerUnit());
+    vecViz.reflow(static_cast<float>(windowSize.x));
+    listViz.reflow(static_cast<float>(windowSize.x));
+
+    if (commandPanel.sync(vecViz.getOperationQueue(),
+                          listViz.getOperationQueue(), windowSize))
+      panelLayer.invalidate();
+
+    if (layered) {
+      if (backgroundLayer.dirty()) {
+        drawBackground(backgroundLayer.begin(sf::Color(30, 30, 30)));
+        backgroundLayer.end();
+      }
+      if (structuresLayer.dirty() || vecViz.needsRedraw() ||
+          listViz.needsRedraw()) {
+        drawStructures(structuresLayer.begin());
+        structuresLayer.end();
+      }
+      if (panelLayer.dirty()) {
+        commandPanel.draw(panelLayer.begin());
+        panelLayer.end();
+      }
+      window.clear(sf::Color(30, 30, 30));
+      backgroundLayer.composite(window);
+      structuresLayer.composite(window);
+      panelLayer.composite(window);
+    } else {
+      window.clear(sf::Color(30, 30, 30));
+      drawBackground(window);
+      drawStructures(window);
+      window.setView(hudView);
+      commandPanel.draw(window);
+    }
+
     sf::Text recInd(recorder.isRecording() ? "REC ON (G)" : "REC OFF (G)", font,
                     14);
     recInd.setFillColor(recorder.isRecording() ? sf::Color(255, 80, 80)
@@ -604,143 +740,74 @@ int main() {
       window.draw(replayText);
     }
 
-    if (exportingFrames || exportingVideo) {
-      std::string baseLabel =
-          "Exportando: " + std::string(exportingFrames ? "Frames" : "") +
-          (exportingFrames && exportingVideo ? " & " : "") +
-          std::string(exportingVideo ? "Video" : "");
-      std::string detail;
-      if (exportingVideo) {
-        std::lock_guard<std::mutex> lk(videoProgressMutex);
-        detail = videoProgressLine;
-      }
-      if (exportingFrames && framesProgressTotal > 0) {
-        double pct =
-            (double)framesProgressCurrent / (double)framesProgressTotal * 100.0;
-        std::ostringstream oss;
-        oss << "frames " << framesProgressCurrent << "/" << framesProgressTotal
-            << " (" << std::fixed << std::setprecision(1) << pct << "%)";
-        if (!detail.empty())
-          detail += " | ";
-
-        detail += oss.str();
-      }
-
-      float secs = exportClock.getElapsedTime().asSeconds();
-      if (secs > 0.f) {
-        std::ostringstream mt;
-        if (exportingFrames && framesProgressCurrent > 0) {
-          double fpsWrite = framesProgressCurrent / secs;
-          mt << std::fixed << std::setprecision(1) << fpsWrite << " fps-save";
-        }
-
-        if (exportingVideo && !detail.empty()) {
-          if (!mt.str().empty())
-            detail += " | ";
-
-          mt << std::fixed << std::setprecision(1) << (secs) << "s";
-        }
-
-        if (!mt.str().empty()) {
-          if (!detail.empty())
-            detail += " | ";
-
-          detail += mt.str();
-        }
-      }
-
-      sf::Text expText(baseLabel + (detail.empty() ? "" : (" | " + detail)),
-                       font, 14);
-      expText.setFillColor(sf::Color(255, 180, 80));
-      float yBase = (recorder.isRecording() || rng.hasSeed())
-                        ? (timedReplayActive ? 109.f : 89.f)
-                        : (timedReplayActive ? 95.f : 75.f);
-      expText.setPosition(15.f, yBase);
-      window.draw(expText);
-
-      float barStartY = yBase + 18.f;
-      float barWidth = 320.f;
-      float barHeight = 10.f;
-
-      if (exportingFrames && framesProgressTotal > 0) {
-        sf::RectangleShape bg(sf::Vector2f(barWidth, barHeight));
-        bg.setPosition(15.f, barStartY);
-        bg.setFillColor(sf::Color(60, 60, 60));
-        window.draw(bg);
-
-        float pctW = (float)framesProgressCurrent / (float)framesProgressTotal *
-                     barWidth;
-        sf::RectangleShape fg(sf::Vector2f(pctW, barHeight));
-        fg.setPosition(15.f, barStartY);
-        fg.setFillColor(sf::Color(100, 200, 100));
-        window.draw(fg);
-        barStartY += 14.f;
-      }
-
-      if (exportingVideo) {
-        size_t posFrame = videoProgressLine.find("frame ");
-        size_t slashPos = videoProgressLine.find('/');
-        double cur = 0, tot = 0;
-
-        if (posFrame != std::string::npos && slashPos != std::string::npos &&
-            slashPos > posFrame) {
-          try {
-            cur = std::stod(videoProgressLine.substr(
-                posFrame + 6, slashPos - (posFrame + 6)));
-          } catch (...) {
-          }
-
-          size_t afterTot = videoProgressLine.find(' ', slashPos + 1);
-
-          if (afterTot == std::string::npos)
-            afterTot = videoProgressLine.size();
-
-          try {
-            tot = std::stod(videoProgressLine.substr(
-                slashPos + 1, afterTot - (slashPos + 1)));
-          } catch (...) {
-          }
+    // Uma linha e uma barra por export ativo, do progresso tipado do job.
+    const auto activeExports = exports.jobs();
+    if (!activeExports.empty()) {
+      float y = (recorder.isRecording() || rng.hasSeed())
+                    ? (timedReplayActive ? 109.f : 89.f)
+                    : (timedReplayActive ? 95.f : 75.f);
+      const float barWidth = 320.f;
+      const float barHeight = 10.f;
+      for (const auto &job : activeExports) {
+        const ExportProgress &p = job->progress();
+        const size_t cur = p.current;
+        const size_t total = p.total;
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(1) << "Exportando "
+             << job->label();
+        if (job->state() == ExportState::Queued) {
+          line << " | na fila";
+        } else {
+          if (total > 0)
+            line << " | frame " << cur << "/" << total << " ("
+                 << p.fraction() * 100.0 << "%)";
+          if (p.fps > 0.0)
+            line << " | " << p.fps.load() << " fps";
+          if (p.bytes > 0)
+            line << " | " << p.bytes / 1048576.0 << " MB";
+          if (p.throughput > 0.0)
+            line << " | " << p.throughput / 1048576.0 << " MB/s, fila "
+                 << p.queueDepth;
+          if (p.speed > 0.0)
+            line << " | " << p.speed.load() << "x";
+          line << " | " << job->elapsed() << "s";
         }
+        if (job->cancelled())
+          line << " | cancelando...";
 
-        if (tot <= 0)
-          tot = (double)vecViz.getCapturedFrameCount();
+        sf::Text expText(line.str(), font, 14);
+        expText.setFillColor(job->cancelled() ? sf::Color(255, 100, 100)
+                                              : sf::Color(255, 180, 80));
+        expText.setPosition(15.f, y);
+        window.draw(expText);
+        y += 18.f;
 
-        if (tot <= 0)
-          tot = (double)vecViz.getCaptureLimit();
-
-        if (tot > 0) {
+        if (total > 0) {
           sf::RectangleShape bg(sf::Vector2f(barWidth, barHeight));
-          bg.setPosition(15.f, barStartY);
+          bg.setPosition(15.f, y);
           bg.setFillColor(sf::Color(60, 60, 60));
           window.draw(bg);
 
-          float pctW = (float)(cur / tot) * barWidth;
-          sf::RectangleShape fg(sf::Vector2f(pctW, barHeight));
-          fg.setPosition(15.f, barStartY);
-          fg.setFillColor(sf::Color(200, 180, 100));
+          sf::RectangleShape fg(sf::Vector2f(
+              static_cast<float>(p.fraction()) * barWidth, barHeight));
+          fg.setPosition(15.f, y);
+          fg.setFillColor(job->kind() == ExportKind::Frames
+                              ? sf::Color(100, 200, 100)
+                              : sf::Color(200, 180, 100));
           window.draw(fg);
-          barStartY += 14.f;
+          y += 14.f;
         }
-
-        if (videoCancelRequested) {
-          sf::Text cancelText("Cancelando...", font, 12);
-          cancelText.setFillColor(sf::Color(255, 100, 100));
-          cancelText.setPosition(15.f, barStartY);
-          window.draw(cancelText);
-        }
-      }
-
-      if (framesCancelRequested) {
-        sf::Text cancelText("Cancelando frames...", font, 12);
-        cancelText.setFillColor(sf::Color(255, 100, 100));
-        cancelText.setPosition(15.f, barStartY);
-        window.draw(cancelText);
       }
     }
 
     if (showLimitStatus) {
-      sf::Text limText("Limite: " + std::to_string(vecViz.getCaptureLimit()) +
-                           " frames (T)",
+      sf::Text limText("Limite: " +
+                           std::to_string(vecViz.getCaptureMemoryUsed() >> 20) +
+                           "/" +
+                           std::to_string(vecViz.getCaptureBudget() >> 20) +
+                           " MB (T), disco " +
+                           std::to_string(vecViz.getCaptureSpilledBytes() >> 20) +
+                           " MB",
                        font, 14);
       limText.setFillColor(sf::Color(180, 255, 180));
       float limYBase = timedReplayActive ? (showSeed ? 89.f : 75.f)
@@ -750,30 +817,35 @@ int main() {
       showLimitStatus = false;
     }
 
-    for (auto &s : subtitles)
-      s.age += dt;
-    subtitles.erase(std::remove_if(subtitles.begin(), subtitles.end(),
-                                   [SUBTITLE_DURATION](const Subtitle &s) {
-                                     return s.age > SUBTITLE_DURATION;
-                                   }),
-                    subtitles.end());
-    float baseY = window.getSize().y - 30.f;
-    sf::Text subT("", font, 16);
-    for (int i = (int)subtitles.size() - 1, line = 0; i >= 0; --i, ++line) {
-      const auto &s = subtitles[i];
-      float alphaRatio = std::max(0.f, SUBTITLE_DURATION - s.age) /
-                         SUBTITLE_DURATION; // fade out
-      sf::Color c(230, 230, 230, static_cast<sf::Uint8>(alphaRatio * 255));
-      subT.setFillColor(c);
-      subT.setString(s.text);
-      sf::FloatRect b = subT.getLocalBounds();
-      subT.setOrigin(b.left + b.width / 2.f, b.top + b.height / 2.f);
-      subT.setPosition(window.getSize().x / 2.f, baseY - line * 22.f);
-      window.draw(subT);
+    subtitles.update(dt);
+    subtitles.draw(window, {window.getSize().x / 2.f, window.getSize().y - 30.f});
+
+    if (frameStats.end() && showFrameStats) {
+      std::cout << "[Perf] frame " << std::fixed << std::setprecision(2)
+                << frameStats.averageMs() << " ms (max "
+                << frameStats.maxMs() << " ms) nos="
+                << vecViz.nodeCount() + listViz.nodeCount();
+      if (captureService.active())
+        std::cout << " captura=" << captureService.stats().averageMs()
+                  << " ms";
+      std::cout << '\n';
+    }
+    if (showFrameStats) {
+      std::ostringstream perf;
+      perf << std::fixed << std::setprecision(2) << "frame "
+           << frameStats.averageMs() << " ms (max " << frameStats.maxMs()
+           << ")";
+      if (captureService.active())
+        perf << " captura " << captureService.stats().averageMs() << " ms";
+      sf::Text perfText(perf.str(), font, 14);
+      perfText.setFillColor(sf::Color(120, 220, 255));
+      perfText.setPosition(window.getSize().x - commandPanel.width() -
+                               perfText.getLocalBounds().width - 20.f,
+                           15.f);
+      window.draw(perfText);
     }
 
-    vecViz.captureFrame(window);
-    listViz.captureFrame(window);
+    captureService.capture(window);
 
     window.display();
 
@@ -11,7 +11,11 @@ pkgs.mkShell {
     sfml
     xorg.libX11
     libxkbcommon
-    ffmpeg            # export futuro de MP4
+    ffmpeg            # export MP4 (CLI e libavcodec/libavformat no processo)
+    libpng            # frames PNG com nivel/filtro configuravel (opcional)
+    zlib              # export APNG (opcional)
+    libwebp           # export WebP animado (opcional)
+    liburing          # gravacao de frames via io_uring (opcional, Linux)
     gtest             # testes unitários (headers + cmake/pkgconfig)
     gcovr
   ];